@@ -8,73 +8,280 @@
 
 #include "algorithms.h"
 #include "lp_algorithms.h"
+#include "flow.h"
+#include "kernels.h"
 #include "macro.h"
 #include "utility.h"
 
+#include <algorithm>
 #include <cassert>
+#include <type_traits>
 
-LpAlgorithm lp_algorithm;
-UniquenessAlgorithm::LpWithUniquenessCheck lp_with_uniqueness_check;
+/*
+ * One instance per thread, so that concurrent tasks never share the state
+ * of an algorithm object.
+ */
+template<class W>
+LpAlgorithm<W>& get_lp_algorithm(){
+    static thread_local LpAlgorithm<W> lp_algorithm;
+    return lp_algorithm;
+}
+
+template<class W>
+UniquenessAlgorithm::LpWithUniquenessCheck<W>& get_lp_with_uniqueness_check(){
+    static thread_local UniquenessAlgorithm::LpWithUniquenessCheck<W> lp_with_uniqueness_check;
+    return lp_with_uniqueness_check;
+}
+
+/**********TwinContraction**********/
+
+/*
+ * Twins are found by sorting the nodes on a hash of their incidence lists,
+ * then on the lists themselves, so only true twins end up next to each
+ * other. Isolated nodes are never contracted: they share the empty list,
+ * but each is a subgraph of its own once no edge is left to be dense.
+ */
+template<class W>
+TwinContraction<W>::TwinContraction(const Hypergraph<W>* g): graph_(g), contracted_(nullptr), number_of_twins_(0){
+    if(std::is_same<W, Unweighted>::value){
+        return;
+    }
+    vector<int> node_ids;
+    vector<Weight<W> > node_weights, weights_of_edges;
+    g->GetNodeWeights(node_ids, node_weights, weights_of_edges);
+    vector<vector<int> > pins;
+    vector<Weight<W> > edge_weights;
+    g->GetEdges(pins, edge_weights);
+    int n = node_ids.size();
+    HashMap<int, int> index;
+    for(int i = 0; i < n; ++i){
+        index[node_ids[i]] = i;
+    }
+    vector<vector<int> > incidence(n);
+    for(int j = 0; j < (int)pins.size(); ++j){
+        for(const auto& node_id:pins[j]){
+            incidence[index[node_id]].push_back(j);
+        }
+    }
+    vector<uint64_t> hashes(n, 14695981039346656037ULL);
+    for(int i = 0; i < n; ++i){
+        for(const auto& j:incidence[i]){
+            hashes[i] = (hashes[i] ^ (uint32_t)j) * 1099511628211ULL;
+        }
+    }
+    vector<int> order(n);
+    for(int i = 0; i < n; ++i){
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](const int x, const int y){
+        if(hashes[x] != hashes[y]){
+            return hashes[x] < hashes[y];
+        }
+        if(incidence[x] != incidence[y]){
+            return incidence[x] < incidence[y];
+        }
+        return node_ids[x] < node_ids[y];
+    });
+    vector<int> representative(n);
+    for(int i = 0; i < n; ++i){
+        bool is_twin = i > 0 && !incidence[order[i]].empty() && hashes[order[i]] == hashes[order[i - 1]] && incidence[order[i]] == incidence[order[i - 1]];
+        representative[order[i]] = is_twin ? representative[order[i - 1]] : order[i];
+        number_of_twins_ += is_twin;
+    }
+    if(number_of_twins_ == 0){
+        return;
+    }
+
+    contracted_ = new Hypergraph<W>();
+    vector<Weight<W> > weights_of_classes(n, 0);
+    for(int i = 0; i < n; ++i){
+        weights_of_classes[representative[i]] += node_weights[i];
+        if(representative[i] != i){
+            vector<int>& members = twins_[node_ids[representative[i]]];
+            if(members.empty()){
+                members.push_back(node_ids[representative[i]]);
+            }
+            members.push_back(node_ids[i]);
+        }
+    }
+    for(int i = 0; i < n; ++i){
+        if(representative[i] == i){
+            contracted_->AddNode(node_ids[i], weights_of_classes[i]);
+        }
+    }
+    for(int j = 0; j < (int)pins.size(); ++j){
+        vector<int> nodes;
+        for(const auto& node_id:pins[j]){
+            nodes.push_back(node_ids[representative[index[node_id]]]);
+        }
+        std::sort(nodes.begin(), nodes.end());
+        nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+        contracted_->AddEdge(nodes, edge_weights[j], j);
+    }
+}
+
+template<class W>
+TwinContraction<W>::~TwinContraction(){
+    delete contracted_;
+}
+
+template<class W>
+const Hypergraph<W>* TwinContraction<W>::get_graph() const{
+    return contracted_ == nullptr ? graph_ : contracted_;
+}
+
+template<class W>
+int TwinContraction<W>::get_number_of_twins() const{
+    return number_of_twins_;
+}
 
-Hypergraph* GreedyAlgorithm(const Hypergraph*);
-Hypergraph* SeiveByNodeDegree(const Hypergraph*, const ld);
-void NodesRemovalForLimitedOverlap(const Hypergraph*, Hypergraph*, const ld, const int way_to_remove_nodes);
+/*
+ * Takes h, a subgraph of the contracted graph, and returns the subgraph of
+ * the original graph induced by all the twins of its nodes.
+ */
+template<class W>
+Hypergraph<W>* TwinContraction<W>::Expand(Hypergraph<W>* h) const{
+    if(contracted_ == nullptr || h == nullptr){
+        return h;
+    }
+    vector<int> nodes;
+    for(const auto& node_id:h->get_node_set()){
+        auto x = twins_.find(node_id);
+        if(x == twins_.end()){
+            nodes.push_back(node_id);
+        }else{
+            nodes.insert(nodes.end(), x->second.begin(), x->second.end());
+        }
+    }
+    delete h;
+    return GenerateInducedSubgraph(graph_, nodes);
+}
 
-Hypergraph* TryRemove(const int node_id, const Hypergraph* g, const ld rho_max){
+template<class W>
+Hypergraph<W>* TryRemove(const int node_id, const Hypergraph<W>* g, const Density<W> rho_max, const TimeBudget& budget){
     #ifdef DEBUG
     LOG("");
     #endif
 
-    Hypergraph* g_minus_u = new Hypergraph(*g);
+    ScratchScope scratch;
+    Hypergraph<W>* g_minus_u = new Hypergraph<W>(*g, &ScratchScope::get_arena());
     g_minus_u->RemoveNodeSet({node_id});
-    Hypergraph* h = lp_algorithm.BasicLp(g_minus_u, true);
+    Hypergraph<W>* h = nullptr;
+    try{
+        /* g - u is no denser than g, so rho_max bounds its optimum. */
+        DensityBounds<W> bounds;
+        bounds.upper = rho_max;
+        h = get_lp_algorithm<W>().BasicLp(g_minus_u, true, budget, bounds);
+    }catch(const char* info){
+        delete g_minus_u;
+        throw;
+    }
     delete g_minus_u;
     if(cmp(h->get_density(), rho_max) >= 0)  return h;
     delete h;
     return nullptr;
 }
 
-Hypergraph* TryEnhance(const int node_id, const Hypergraph* g, const ld rho_max){
+template<class W>
+Hypergraph<W>* TryEnhance(const int node_id, const Hypergraph<W>* g, const Density<W> rho_max, const TimeBudget& budget){
     #ifdef DEBUG
     LOG("");
     #endif
     
-    Hypergraph* h = lp_algorithm.ModifiedLp(g, node_id, rho_max, true);
+    Hypergraph<W>* h = get_lp_algorithm<W>().ModifiedLp(g, node_id, rho_max, true, budget);
     return h;
 }
 
-Hypergraph* FindMinimal(const Hypergraph* g){
+template<class W>
+Hypergraph<W>* FindMinimal(const Hypergraph<W>* g){
     #ifdef DEBUG
     LOG("");
     #endif
     
-    Hypergraph* greedy_denest_subgraph = GreedyAlgorithm(g);
-    ld rho_apx = greedy_denest_subgraph->get_density();
-    delete greedy_denest_subgraph;
-    Hypergraph* g_bar = SeiveByNodeDegree(g, rho_apx);
+    TwinContraction<W> contraction(g);
+    if(contraction.get_number_of_twins() > 0){
+        Console::Show("........Contracted " + Int2String(contraction.get_number_of_twins()) + " twin nodes.");
+    }
+    PeelingOrder<W> order(contraction.get_graph());
+    bool is_minimal = false;
+    return contraction.Expand(FindMinimal(contraction.get_graph(), order.get_density_bounds(), TimeBudget(), is_minimal, &order));
+}
+
+/*
+ * Returns nullptr if the budget runs out before a densest subgraph is known,
+ * otherwise the smallest densest subgraph reached so far; is_minimal tells
+ * whether the refinement finished. The graph is sieved by the lower bound,
+ * read off the peeling of g when one is given, and the bounds are passed on
+ * to the first LP.
+ */
+template<class W>
+Hypergraph<W>* FindMinimal(const Hypergraph<W>* g, const DensityBounds<W>& bounds, const TimeBudget& budget, bool& is_minimal, const PeelingOrder<W>* order){
+    #ifdef DEBUG
+    LOG("");
+    #endif
+    
+    MemoryPhase phase("find-minimal");
+    is_minimal = false;
+    Hypergraph<W>* g_bar = order != nullptr ? SeiveByNodeDegree(g, *order, bounds.lower) : SeiveByNodeDegree(g, bounds.lower);
     Console::Show("........Graph after pruning: " + Int2String(g_bar->get_number_of_nodes()) + " nodes, " + Int2String(g_bar->get_number_of_edges()) + " edges, density = " + Double2String(g_bar->get_density()) + ".");
-    Hypergraph* h = lp_algorithm.BasicLp(g_bar, true);
+    Hypergraph<W>* h = nullptr;
+    try{
+        h = get_lp_algorithm<W>().BasicLp(g_bar, true, budget, bounds);
+    }catch(const char* info){
+        delete g_bar;
+        return nullptr;
+    }
     delete g_bar;
-    ld rho_max = h->get_density();
-    Hypergraph* ans = nullptr;
+    Density<W> rho_max = h->get_density();
+    Hypergraph<W>* ans = nullptr;
     while(true){
         if(h->get_number_of_nodes() == 1){
-            ans = new Hypergraph(*h);
+            ans = new Hypergraph<W>(*h);
+            is_minimal = true;
             break;
         }
+        if(budget.is_expired()){
+            return h;
+        }
         int u_id = h->get_random_node_id();
-        Hypergraph* h1 = TryRemove(u_id, h, rho_max);
-        Hypergraph* h2 = TryEnhance(u_id, h, rho_max);
-        if(h1 == nullptr){
+        Hypergraph<W>* h1 = nullptr;
+        Hypergraph<W>* h2 = nullptr;
+        bool is_removable = false;
+        vector<int> nodes_of_h1;
+        Weight<W> weight_of_h1 = 0;
+        try{
+            h1 = TryRemove(u_id, h, rho_max, budget);
+            is_removable = h1 != nullptr;
+            if(is_removable){
+                weight_of_h1 = h1->get_weight_of_nodes();
+            }
+            if(is_removable && MemoryTracker::is_limited()){
+                /* Only the node set of h1 is kept while h2 is solved for. */
+                set node_set = h1->get_node_set();
+                nodes_of_h1.assign(node_set.begin(), node_set.end());
+                delete h1;
+                h1 = nullptr;
+            }
+            h2 = TryEnhance(u_id, h, rho_max, budget);
+        }catch(const char* info){
+            delete h1;
+            return h;
+        }
+        if(!is_removable){
+            is_minimal = true;
             ans = h2;
             break;
         }
-        delete h;
-        if(cmp(h1->get_weight_of_nodes(), h2->get_weight_of_nodes()) < 0){
+        if(cmp(weight_of_h1, h2->get_weight_of_nodes()) < 0){
             delete h2;
+            if(h1 == nullptr){
+                h1 = GenerateInducedSubgraph((const Hypergraph<W>*)h, nodes_of_h1);
+            }
+            delete h;
             h = h1;
         }else{
             delete h1;
+            delete h;
             h = h2;
         }
     }
@@ -82,15 +289,16 @@ Hypergraph* FindMinimal(const Hypergraph* g){
     return ans;
 }
 
-vector<Hypergraph*> FindAllMinimal(const Hypergraph* g){
+template<class W>
+vector<Hypergraph<W>*> FindAllMinimal(const Hypergraph<W>* g){
     #ifdef DEBUG
     LOG("");
     #endif
     
-    vector<Hypergraph*> l;
-    Hypergraph* g_bar = new Hypergraph(*g);
+    vector<Hypergraph<W>*> l;
+    Hypergraph<W>* g_bar = g->GenerateResidual();
     while(true){
-        Hypergraph* h = FindMinimal(g_bar);
+        Hypergraph<W>* h = FindMinimal(g_bar);
         if(l.empty()){
             l.push_back(h);
         }else if(cmp(h->get_density(), l[0]->get_density()) >= 0){
@@ -105,16 +313,23 @@ vector<Hypergraph*> FindAllMinimal(const Hypergraph* g){
     return l;
 }
 
-vector<Hypergraph*> ApproxMinAndRemove(const Hypergraph* g, const int k, const ld alpha, const bool is_approx, const int way_to_remove_nodes, Output& output){
+template<class W>
+vector<Hypergraph<W>*> ApproxMinAndRemove(const Hypergraph<W>* g, const int k, const double alpha, const bool is_approx, const int way_to_remove_nodes, Output& output, const vector<vector<int> >& prefix, Checkpoint* checkpoint){
     #ifdef DEBUG
     LOG("");
     #endif
     
-    vector<Hypergraph*> l;
-    Hypergraph* h = new Hypergraph(*g);
+    vector<Hypergraph<W>*> l;
+    Hypergraph<W>* h = g->GenerateResidual();
+    if(checkpoint != nullptr){
+        checkpoint->Restore(g, h, l);
+    }
+    AsyncOutput writer(output);
     while((l.size() < k) && !h->is_empty()){
-        Hypergraph* g_i = nullptr;
-        if(is_approx){
+        Hypergraph<W>* g_i = nullptr;
+        if(l.size() < prefix.size()){
+            g_i = GenerateInducedSubgraph(h, prefix[l.size()]);
+        }else if(is_approx){
             g_i = GreedyAlgorithm(h);
         }else{
             g_i = FindMinimal(h);
@@ -124,107 +339,140 @@ vector<Hypergraph*> ApproxMinAndRemove(const Hypergraph* g, const int k, const l
         Console::Show("[" + Int2String(l.size()) + "]\t" + Int2String(g_i->get_number_of_nodes()) + " nodes, " + Int2String(g_i->get_number_of_edges()) + " edges, density = " + Double2String(g_i->get_density()));
         Console::Show("");
         #ifndef TURNOFFGRAPHOUTPUT
-        output.PrintLine(g_i->Show() + FEATURE("Density", Double2String(g_i->get_density())));
+        string trailer = FEATURE("Density", Double2String(g_i->get_density()));
+        writer.Submit([g_i, trailer](Output& output){ g_i->Print(output, trailer); });
         #endif // TURNOFFGRAPHOUTPUT
         NodesRemovalForLimitedOverlap(g_i, h, alpha, way_to_remove_nodes);
+        if(checkpoint != nullptr){
+            writer.Wait();
+            checkpoint->Record(g, h, l, output);
+        }
     }
+    delete h;
     return l;
 }
 
-Hypergraph* NaiveAlgorithm::FindDensestByDp(const Hypergraph* g){
+template<class W>
+Hypergraph<W>* NaiveAlgorithm::FindDensestByDp(const Hypergraph<W>* g){
     #ifdef DEBUG
     LOG("");
     #endif
     
-    Hypergraph* greedy_denest_subgraph = GreedyAlgorithm(g);
-    ld rho_apx = greedy_denest_subgraph->get_density();
-    delete greedy_denest_subgraph;
-    Hypergraph* g_bar = SeiveByNodeDegree(g, rho_apx);
-    Hypergraph* h = lp_algorithm.BasicLp(g_bar, true);
+    /* The greedy node set need not survive twin contraction, so only its density is passed on. */
+    PeelingOrder<W> order(g);
+    DensityBounds<W> bounds;
+    bounds.lower = order.get_greedy_density();
+    bounds.upper = order.get_upper_bound();
+    Hypergraph<W>* g_bar = SeiveByNodeDegree(g, order, bounds.lower);
+    Hypergraph<W>* h = nullptr;
+    {
+        TwinContraction<W> contraction(g_bar);
+        h = contraction.Expand(get_lp_algorithm<W>().BasicLp(contraction.get_graph(), true, TimeBudget(), bounds));
+    }
     delete g_bar;
     return h;
 }
 
-vector<Hypergraph*> NaiveAlgorithm::NaiveDensest(const Hypergraph* g, const int k, Output& output){
+template<class W>
+vector<Hypergraph<W>*> NaiveAlgorithm::NaiveDensest(const Hypergraph<W>* g, const int k, Output& output, const vector<vector<int> >& prefix, Checkpoint* checkpoint){
     #ifdef DEBUG
     LOG("");
     #endif
     
-    vector<Hypergraph*> l;
-    Hypergraph* h = new Hypergraph(*g);
+    vector<Hypergraph<W>*> l;
+    Hypergraph<W>* h = g->GenerateResidual();
+    if(checkpoint != nullptr){
+        checkpoint->Restore(g, h, l);
+    }
+    AsyncOutput writer(output);
     while((l.size() < k) && !h->is_empty()){
-        Hypergraph* g_i = FindDensestByDp(h);
+        Hypergraph<W>* g_i = l.size() < prefix.size() ? GenerateInducedSubgraph(h, prefix[l.size()]) : FindDensestByDp(h);
         l.push_back(g_i);
         //Console::Log("[" + Int2String(l.size()) + "]\t" + Int2String(g_i->get_number_of_nodes()) + " nodes, " + Int2String(g_i->get_number_of_edges()) + " edges, density = " + Double2String(g_i->get_density()));
         Console::Show("[" + Int2String(l.size()) + "]\t" + Int2String(g_i->get_number_of_nodes()) + " nodes, " + Int2String(g_i->get_number_of_edges()) + " edges, density = " + Double2String(g_i->get_density()));
         Console::Show("");
         #ifndef TURNOFFGRAPHOUTPUT
-        output.PrintLine(g_i->Show() + FEATURE("Density", Double2String(g_i->get_density())));
+        string trailer = FEATURE("Density", Double2String(g_i->get_density()));
+        writer.Submit([g_i, trailer](Output& output){ g_i->Print(output, trailer); });
         #endif // TURNOFFGRAPHOUTPUT
         h->RemoveNodeSet(g_i->get_node_set());
+        if(checkpoint != nullptr){
+            writer.Wait();
+            checkpoint->Record(g, h, l, output);
+        }
     }
+    delete h;
     return l;
 }
 
-vector<Hypergraph*> NaiveAlgorithm::NaiveApprox(const Hypergraph* g, const int k, Output& output){
+template<class W>
+vector<Hypergraph<W>*> NaiveAlgorithm::NaiveApprox(const Hypergraph<W>* g, const int k, Output& output, const vector<vector<int> >& prefix, Checkpoint* checkpoint){
     #ifdef DEBUG
     LOG("");
     #endif
     
-    vector<Hypergraph*> l;
-    Hypergraph* h = new Hypergraph(*g);
+    vector<Hypergraph<W>*> l;
+    Hypergraph<W>* h = g->GenerateResidual();
+    if(checkpoint != nullptr){
+        checkpoint->Restore(g, h, l);
+    }
+    AsyncOutput writer(output);
     while((l.size() < k) && !h->is_empty()){
-        Hypergraph* g_i = GreedyAlgorithm(h);
+        Hypergraph<W>* g_i = l.size() < prefix.size() ? GenerateInducedSubgraph(h, prefix[l.size()]) : GreedyAlgorithm(h);
         l.push_back(g_i);
         //Console::Log("[" + Int2String(l.size()) + "]\t" + Int2String(g_i->get_number_of_nodes()) + " nodes, " + Int2String(g_i->get_number_of_edges()) + " edges, density = " + Double2String(g_i->get_density()));
         Console::Show("[" + Int2String(l.size()) + "]\t" + Int2String(g_i->get_number_of_nodes()) + " nodes, " + Int2String(g_i->get_number_of_edges()) + " edges, density = " + Double2String(g_i->get_density()));
         Console::Show("");
         #ifndef TURNOFFGRAPHOUTPUT
-        output.PrintLine(g_i->Show() + FEATURE("Density", Double2String(g_i->get_density())));
+        string trailer = FEATURE("Density", Double2String(g_i->get_density()));
+        writer.Submit([g_i, trailer](Output& output){ g_i->Print(output, trailer); });
         #endif // TURNOFFGRAPHOUTPUT
         h->RemoveNodeSet(g_i->get_node_set());
+        if(checkpoint != nullptr){
+            writer.Wait();
+            checkpoint->Record(g, h, l, output);
+        }
     }
+    delete h;
     return l;
 }
 
-Hypergraph* UniquenessAlgorithm::FindDensestSubgraph(const Hypergraph* g){
+template<class W>
+Hypergraph<W>* UniquenessAlgorithm::FindDensestSubgraph(const Hypergraph<W>* g){
     #ifdef DEBUG
     LOG("");
     #endif
     
-    Hypergraph* greedy_denest_subgraph = GreedyAlgorithm(g);
-    ld rho_apx = greedy_denest_subgraph->get_density();
-    delete greedy_denest_subgraph;
-    Hypergraph* g_bar = SeiveByNodeDegree(g, rho_apx);
-    Hypergraph* h = lp_algorithm.BasicLp(g_bar, true);
+    PeelingOrder<W> order(g);
+    Hypergraph<W>* g_bar = SeiveByNodeDegree(g, order, order.get_greedy_density());
+    Hypergraph<W>* h = get_lp_algorithm<W>().BasicLp(g_bar, true);
     delete g_bar;
     return h;
 }
 
-bool UniquenessAlgorithm::CheckByFindMinimal(const Hypergraph* g, Hypergraph*& ans){
+template<class W>
+bool UniquenessAlgorithm::CheckByFindMinimal(const Hypergraph<W>* g, Hypergraph<W>*& ans){
     #ifdef DEBUG
     LOG("");
     #endif
 
-    Hypergraph* greedy_denest_subgraph = GreedyAlgorithm(g);
-    ld rho_apx = greedy_denest_subgraph->get_density();
-    delete greedy_denest_subgraph;
-    Hypergraph* g_bar = SeiveByNodeDegree(g, rho_apx);
-    Hypergraph* h = nullptr;
-    bool flag = lp_with_uniqueness_check.BasicLp(g_bar, true, h);
+    PeelingOrder<W> order(g);
+    Hypergraph<W>* g_bar = SeiveByNodeDegree(g, order, order.get_greedy_density());
+    Hypergraph<W>* h = nullptr;
+    bool flag = get_lp_with_uniqueness_check<W>().BasicLp(g_bar, true, h);
     delete g_bar;
     if(!flag){
         delete h;
         return false;
     }
-    ld rho_max = h->get_density();
+    Density<W> rho_max = h->get_density();
     if(h->get_number_of_nodes() == 1){
         ans = h;
         return true;
     }
     int u_id = h->get_random_node_id();
-    Hypergraph* h1 = TryRemove(u_id, h, rho_max);
-    Hypergraph* h2 = TryEnhance(u_id, h, rho_max);
+    Hypergraph<W>* h1 = TryRemove(u_id, h, rho_max);
+    Hypergraph<W>* h2 = TryEnhance(u_id, h, rho_max);
     if(h1 == nullptr){
         ans = h2;
         delete h1;
@@ -237,75 +485,348 @@ bool UniquenessAlgorithm::CheckByFindMinimal(const Hypergraph* g, Hypergraph*& a
     return flag;
 }
 
-bool UniquenessAlgorithm::CheckByPruning(const Hypergraph* g, const set densest_part, const ld rho_max){
+template<class W>
+bool UniquenessAlgorithm::CheckByPruning(const Hypergraph<W>* g, const set densest_part, const Density<W> rho_max){
     #ifdef DEBUG
     LOG("");
     #endif
     
-    HypergraphWithPruningEdge* h = new HypergraphWithPruningEdge(*g);
+    HypergraphWithPruningEdge<W>* h = new HypergraphWithPruningEdge<W>(*g);
     h->RemoveNodeSet(densest_part);
     if(h->get_number_of_edges()==0) return true;
-    Hypergraph* second_minimal = FindDensestSubgraph((Hypergraph*)h);
+    Hypergraph<W>* second_minimal = FindDensestSubgraph((Hypergraph<W>*)h);
     return cmp(rho_max, second_minimal->get_density()) > 0;
 }
 
-bool UniquenessAlgorithm::Check(const Hypergraph* g){
+/*
+ * One exact solve by parametric flow instead of an LP per candidate node:
+ * the minimal densest subgraph is unique iff the residual graph of the last
+ * min cut has a single sink component (see FlowAlgorithm::Solve).
+ */
+template<class W>
+bool UniquenessAlgorithm::Check(const Hypergraph<W>* g){
     #ifdef DEBUG
     LOG("");
     #endif
     
-    Hypergraph* h = nullptr;
-    if(!CheckByFindMinimal(g, h)){
-        return false;
+    return FlowAlgorithm::Solve(g).is_unique();
+}
+
+template<class W>
+vector<Hypergraph<W>*> AnytimeMinAndRemove(const Hypergraph<W>* g, const int k, const double alpha, const int way_to_remove_nodes, const TimeBudget& budget, vector<Density<W> >& upper_bounds, Output& output){
+    #ifdef DEBUG
+    LOG("");
+    #endif
+    
+    vector<Hypergraph<W>*> l;
+    upper_bounds.clear();
+    int number_of_exact_rounds = 0;
+    Hypergraph<W>* h = g->GenerateResidual();
+    while(((int)l.size() < k) && !h->is_empty()){
+        PeelingOrder<W> order(h);
+        Density<W> upper_bound = order.get_upper_bound();
+        Hypergraph<W>* g_i = GreedyAlgorithm((const Hypergraph<W>*)h, order);
+        string status = "approximate";
+        if(!budget.is_expired()){
+            bool is_minimal = false;
+            Hypergraph<W>* h_i = FindMinimal(h, order.get_density_bounds(), budget, is_minimal, &order);
+            if(h_i != nullptr){
+                delete g_i;
+                g_i = h_i;
+                upper_bound = g_i->get_density();
+                status = is_minimal ? "exact" : "exact (minimality not verified)";
+                ++number_of_exact_rounds;
+            }
+        }
+        l.push_back(g_i);
+        upper_bounds.push_back(upper_bound);
+        Console::Show("[" + Int2String(l.size()) + "]\t" + Int2String(g_i->get_number_of_nodes()) + " nodes, " + Int2String(g_i->get_number_of_edges()) + " edges, density = " + Double2String(g_i->get_density()) + ", upper bound = " + Double2String(upper_bound) + ", " + status);
+        Console::Show("");
+        #ifndef TURNOFFGRAPHOUTPUT
+        g_i->Print(output, FEATURE("Density", Double2String(g_i->get_density())) + FEATURE("Upper bound", Double2String(upper_bound)) + FEATURE("Status", status));
+        #endif // TURNOFFGRAPHOUTPUT
+        NodesRemovalForLimitedOverlap(g_i, h, alpha, way_to_remove_nodes);
     }
-    return CheckByPruning(g, h->get_node_set(), h->get_density());
+    delete h;
+    Console::Show(Int2String(number_of_exact_rounds) + " of " + Int2String(l.size()) + " rounds are exact.");
+    output.PrintLine(Int2String(number_of_exact_rounds) + " of " + Int2String(l.size()) + " rounds are exact.");
+    return l;
 }
 
-/**********GreedyAlgorithm**********/
+/**********GenerateInducedSubgraph**********/
 
-Hypergraph* GreedyAlgorithm(const Hypergraph* g){
+/*
+ * The subgraph of g induced by the given nodes; nodes missing from g are
+ * ignored.
+ */
+template<class W>
+Hypergraph<W>* GenerateInducedSubgraph(const Hypergraph<W>* g, const vector<int>& nodes){
+    return g->GenerateSubgraph(set(nodes.begin(), nodes.end()));
+}
+
+/**********PeelingOrder**********/
+
+template<class W>
+PeelingOrder<W>::PeelingOrder(const Hypergraph<W>* g): densest_position_(0), max_degree_(0){
     #ifdef DEBUG
     LOG("");
     #endif
     
-    vector<int> node_set;
-    vector<ld> weight_before_removal;
-    Hypergraph* ans = new Hypergraph(*g);
-    HypergraphWithHeap* h = new HypergraphWithHeap(*g);
+    MemoryPhase phase("greedy");
+    int n = g->get_number_of_nodes();
+    node_ids_.reserve(n);
+    degrees_.reserve(n);
+    densities_.reserve(n);
+    core_numbers_.reserve(n);
+    if(g->get_incidence() != nullptr){
+        Peel(g, *g->get_incidence());
+    }else{
+        Peel(g);
+    }
+    for(int i = 0; i < n; ++i){
+        if(cmp(densities_[i], densities_[densest_position_]) > 0){
+            densest_position_ = i;
+        }
+    }
+}
+
+template<class W>
+void PeelingOrder<W>::Peel(const Hypergraph<W>* g){
+    ScratchScope scratch;
+    HypergraphWithHeap<W>* h = new HypergraphWithHeap<W>(*g, &ScratchScope::get_arena());
     while(!h->is_empty()){
-        weight_before_removal.push_back(h->get_density());
+        densities_.push_back(h->get_density());
         int u_id = h->Top();
-        //Console::Log("u.id: " + Int2String(u_id) + "; degree: " + Double2String(h->get_degree_of_node(u_id)) + "; h->density: " + Double2String(h->get_density()));
         assert(h->has_node(u_id));
+        Density<W> degree = h->get_degree_of_node(u_id);
+        if(degree > max_degree_){
+            max_degree_ = degree;
+        }
         h->Pop();
-        node_set.push_back(u_id);
+        node_ids_.push_back(u_id);
+        degrees_.push_back(degree);
+        core_numbers_.push_back(max_degree_);
+    }
+    delete h;
+}
+
+/*
+ * The same peeling with per-node sums of edge weights and a flag per node
+ * and per edge in place of the copy; what g lacks starts out removed.
+ * Nodes are numbered in order of id, so the heap breaks ties as on g.
+ */
+template<class W>
+void PeelingOrder<W>::Peel(const Hypergraph<W>* g, const CompressedIncidence<W>& incidence){
+    int n = incidence.get_number_of_nodes(), m = incidence.get_number_of_edges();
+    vector<Weight<W> > weights_of_edges(n, 0);
+    vector<bool> is_peeled(n), is_erased(m);
+    Weight<W> weight_of_nodes = 0, weight_of_edges = 0;
+    for(int i = 0; i < n; ++i){
+        is_peeled[i] = !g->has_node(incidence.get_node_id(i));
+    }
+    for(int j = 0; j < m; ++j){
+        is_erased[j] = !g->has_edge(incidence.get_edge_id(j));
+        if(is_erased[j]){
+            continue;
+        }
+        Weight<W> weight = incidence.get_weight_of_edge(j);
+        weight_of_edges += weight;
+        for(const auto& i:incidence.get_pins(j)){
+            weights_of_edges[i] += weight;
+        }
+    }
+    auto get_degree = [&](const int i){
+        Weight<W> weight = incidence.get_weight_of_node(i);
+        return cmp(weight, 0) == 0 ? (Density<W>)0 : (Density<W>)weights_of_edges[i] / weight;
+    };
+    MemoryCharge charge("heap", 64LL * n);
+    typename PeelingQueue<W>::Type heap;
+    for(int i = 0; i < n; ++i){
+        if(!is_peeled[i]){
+            weight_of_nodes += incidence.get_weight_of_node(i);
+            heap.push(i, get_degree(i));
+        }
     }
-    int number_of_nodes_to_be_removed = 0;
-    for(int i = 0; i < g->get_number_of_nodes(); ++i){
-        if(cmp(weight_before_removal[i], weight_before_removal[number_of_nodes_to_be_removed]) > 0){
-            number_of_nodes_to_be_removed = i;
+    for(int r = g->get_number_of_nodes(); r > 0; --r){
+        densities_.push_back(cmp(weight_of_nodes, 0) == 0 ? (Density<W>)0 : (Density<W>)weight_of_edges / weight_of_nodes);
+        int u = heap.top();
+        Density<W> degree = get_degree(u);
+        if(degree > max_degree_){
+            max_degree_ = degree;
+        }
+        for(const auto& j:incidence.get_edges(u)){
+            if(is_erased[j]){
+                continue;
+            }
+            is_erased[j] = true;
+            Weight<W> weight = incidence.get_weight_of_edge(j);
+            for(const auto& i:incidence.get_pins(j)){
+                weights_of_edges[i] -= weight;
+                if(!is_peeled[i]){
+                    heap.modify(i, get_degree(i));
+                }
+            }
+            weight_of_edges -= weight;
         }
+        heap.erase(u);
+        is_peeled[u] = true;
+        weight_of_nodes -= incidence.get_weight_of_node(u);
+        node_ids_.push_back(incidence.get_node_id(u));
+        degrees_.push_back(degree);
+        core_numbers_.push_back(max_degree_);
     }
-    Console::Log("number of nodes to be removed = " + Int2String(number_of_nodes_to_be_removed));
-    node_set.resize(number_of_nodes_to_be_removed);
-    set node_set_to_be_deleted(node_set.begin(), node_set.end());
-    ans->RemoveNodeSet(node_set_to_be_deleted);
+}
+
+template<class W>
+int PeelingOrder<W>::get_number_of_nodes() const{
+    return node_ids_.size();
+}
+
+template<class W>
+int PeelingOrder<W>::get_node_id(const int position) const{
+    return node_ids_[position];
+}
+
+template<class W>
+Density<W> PeelingOrder<W>::get_degree(const int position) const{
+    return degrees_[position];
+}
+
+template<class W>
+Density<W> PeelingOrder<W>::get_density(const int position) const{
+    return densities_[position];
+}
+
+template<class W>
+Density<W> PeelingOrder<W>::get_core_number(const int position) const{
+    return core_numbers_[position];
+}
+
+template<class W>
+int PeelingOrder<W>::get_densest_position() const{
+    return densest_position_;
+}
+
+/* Core numbers never decrease along the order, so the suffix is found by binary search. */
+template<class W>
+int PeelingOrder<W>::get_core_position(const Density<W> rho) const{
+    return std::lower_bound(core_numbers_.begin(), core_numbers_.end(), rho, [](const Density<W> a, const Density<W> b){
+        return cmp(a, b) < 0;
+    }) - core_numbers_.begin();
+}
+
+template<class W>
+Density<W> PeelingOrder<W>::get_greedy_density() const{
+    return densities_.empty() ? 0 : densities_[densest_position_];
+}
+
+/*
+ * Every node of a densest subgraph has degree at least its density, so the
+ * largest degree seen at removal bounds the optimum from above.
+ */
+template<class W>
+Density<W> PeelingOrder<W>::get_upper_bound() const{
+    return max_degree_;
+}
+
+template<class W>
+DensityBounds<W> PeelingOrder<W>::get_density_bounds() const{
+    DensityBounds<W> bounds;
+    bounds.lower = get_greedy_density();
+    bounds.upper = max_degree_;
+    bounds.lower_node_set = GetSuffix(densest_position_);
+    return bounds;
+}
+
+template<class W>
+vector<int> PeelingOrder<W>::GetSuffix(const int position) const{
+    return vector<int>(node_ids_.begin() + position, node_ids_.end());
+}
+
+template<class W>
+void PeelingOrder<W>::GetCoreNumbers(HashMap<int, Density<W> >& core_numbers) const{
+    core_numbers.clear();
+    core_numbers.reserve(node_ids_.size());
+    for(int i = 0; i < (int)node_ids_.size(); ++i){
+        core_numbers[node_ids_[i]] = core_numbers_[i];
+    }
+}
+
+/* g must be the peeled graph; only the suffix is copied. */
+template<class W>
+Hypergraph<W>* PeelingOrder<W>::GenerateSuffix(const Hypergraph<W>* g, const int position) const{
+    return g->GenerateSubgraph(set(node_ids_.begin() + position, node_ids_.end()));
+}
+
+/**********GreedyAlgorithm**********/
+
+template<class W>
+Hypergraph<W>* GreedyAlgorithm(const Hypergraph<W>* g){
+    Density<W> upper_bound = 0;
+    return GreedyAlgorithm(g, upper_bound);
+}
+
+template<class W>
+Hypergraph<W>* GreedyAlgorithm(const Hypergraph<W>* g, Density<W>& upper_bound){
+    #ifdef DEBUG
+    LOG("");
+    #endif
+    
+    PeelingOrder<W> order(g);
+    upper_bound = order.get_upper_bound();
+    return GreedyAlgorithm(g, order);
+}
+
+template<class W>
+Hypergraph<W>* GreedyAlgorithm(const Hypergraph<W>* g, const PeelingOrder<W>& order){
+    #ifdef DEBUG
+    LOG("");
+    #endif
+    
+    Console::Log("number of nodes to be removed = " + Int2String(order.get_densest_position()));
+    Hypergraph<W>* ans = order.GenerateSuffix(g, order.get_densest_position());
     Console::Log("density = " + Double2String(ans->get_density()));
-    delete h;
     return ans;
 }
 
 /**********SeiveByNodeDengree**********/
 
-Hypergraph* SeiveByNodeDegree(const Hypergraph* g, const ld rho_apx){
+/*
+ * Low-degree nodes are first removed in batches with the vectorized degree
+ * kernels; once a scan removes only a few nodes, the heap finishes the job.
+ */
+template<class W>
+Hypergraph<W>* SeiveByNodeDegree(const Hypergraph<W>* g, const Density<W> rho_apx){
     #ifdef DEBUG
     LOG("");
     #endif
 
+    MemoryPhase phase("sieve");
     Console::Show("........Rho_apx = " + Double2String(rho_apx));
     
-    HypergraphWithHeap* h = new HypergraphWithHeap(*g);
-    while(true){
+    ScratchScope scratch;
+    HypergraphWithHeap<W>* h = new HypergraphWithHeap<W>(*g, &ScratchScope::get_arena());
+    vector<int> node_ids;
+    vector<Weight<W> > weights, weights_of_edges;
+    ArenaVector<Density<W> > degrees(scratch.get_allocator<Density<W> >());
+    ArenaVector<int> indices(scratch.get_allocator<int>());
+    while(!h->is_empty()){
+        h->GetNodeWeights(node_ids, weights, weights_of_edges);
+        int n = node_ids.size();
+        degrees.resize(n);
+        indices.resize(n);
+        Kernels::BatchDegree(weights_of_edges.data(), weights.data(), n, degrees.data());
+        int cnt = Kernels::FilterBelow(degrees.data(), n, (Density<W>)(rho_apx - kEps), indices.data());
+        set node_set_to_be_deleted;
+        for(int i = 0; i < cnt; ++i){
+            node_set_to_be_deleted.insert(node_ids[indices[i]]);
+        }
+        h->RemoveNodeSet(node_set_to_be_deleted);
+        if(cnt * 16 < n){
+            break;
+        }
+    }
+    while(!h->is_empty()){
         int u_id = h->Top();
         if(cmp(h->get_degree_of_node(u_id), rho_apx) < 0){
             h->Pop();
@@ -313,25 +834,37 @@ Hypergraph* SeiveByNodeDegree(const Hypergraph* g, const ld rho_apx){
             break;
         }
     }
-    Hypergraph* g_bar = new Hypergraph(*(Hypergraph*)h);
+    Hypergraph<W>* g_bar = new Hypergraph<W>(*(Hypergraph<W>*)h);
     delete h;
     return g_bar;
 }
 
+template<class W>
+Hypergraph<W>* SeiveByNodeDegree(const Hypergraph<W>* g, const PeelingOrder<W>& order, const Density<W> rho_apx){
+    #ifdef DEBUG
+    LOG("");
+    #endif
+
+    MemoryPhase phase("sieve");
+    Console::Show("........Rho_apx = " + Double2String(rho_apx));
+    return order.GenerateSuffix(g, order.get_core_position(rho_apx));
+}
+
 /**********NodesRemovalForLimitedOverlap**********/
 
-void NodesRemovalForLimitedOverlap(const Hypergraph* g_i, Hypergraph* h, const ld alpha, const int way_to_remove_nodes){
+template<class W>
+void NodesRemovalForLimitedOverlap(const Hypergraph<W>* g_i, Hypergraph<W>* h, const double alpha, const int way_to_remove_nodes){
     #ifdef DEBUG
     LOG("");
     #endif
     
-    Hypergraph* temp;
+    Hypergraph<W>* temp;
     if(way_to_remove_nodes == 1){
-        temp = Hypergraph::GenerateInducement(*g_i, *h);
+        temp = Hypergraph<W>::GenerateInducement(*g_i, *h);
     }else{
-        temp = Hypergraph::GenerateComplement(*g_i, *h);
+        temp = Hypergraph<W>::GenerateComplement(*g_i, *h);
     }
-    HypergraphWithHeap* s = new HypergraphWithHeap(*temp);
+    HypergraphWithHeap<W>* s = new HypergraphWithHeap<W>(*temp);
     delete temp;
 
     while(cmp(s->get_weight_of_nodes(), alpha * g_i->get_weight_of_nodes()) > 0){
@@ -342,3 +875,24 @@ void NodesRemovalForLimitedOverlap(const Hypergraph* g_i, Hypergraph* h, const l
     delete s;
 }
 
+#define INSTANTIATE_ALGORITHMS(W) \
+template class TwinContraction<W>; \
+template class PeelingOrder<W>; \
+template Hypergraph<W>* FindMinimal(const Hypergraph<W>*); \
+template Hypergraph<W>* FindMinimal(const Hypergraph<W>*, const DensityBounds<W>&, const TimeBudget&, bool&, const PeelingOrder<W>*); \
+template vector<Hypergraph<W>*> FindAllMinimal(const Hypergraph<W>*); \
+template vector<Hypergraph<W>*> ApproxMinAndRemove(const Hypergraph<W>*, const int, const double, const bool, const int, Output&, const vector<vector<int> >&, Checkpoint*); \
+template vector<Hypergraph<W>*> AnytimeMinAndRemove(const Hypergraph<W>*, const int, const double, const int, const TimeBudget&, vector<Density<W> >&, Output&); \
+template vector<Hypergraph<W>*> NaiveAlgorithm::NaiveApprox(const Hypergraph<W>*, const int, Output&, const vector<vector<int> >&, Checkpoint*); \
+template vector<Hypergraph<W>*> NaiveAlgorithm::NaiveDensest(const Hypergraph<W>*, const int, Output&, const vector<vector<int> >&, Checkpoint*); \
+template bool UniquenessAlgorithm::Check(const Hypergraph<W>*); \
+template Hypergraph<W>* UniquenessAlgorithm::FindDensestSubgraph(const Hypergraph<W>*); \
+template Hypergraph<W>* GreedyAlgorithm(const Hypergraph<W>*); \
+template Hypergraph<W>* GreedyAlgorithm(const Hypergraph<W>*, Density<W>&); \
+template Hypergraph<W>* GreedyAlgorithm(const Hypergraph<W>*, const PeelingOrder<W>&); \
+template void NodesRemovalForLimitedOverlap(const Hypergraph<W>*, Hypergraph<W>*, const double, const int); \
+template Hypergraph<W>* GenerateInducedSubgraph(const Hypergraph<W>*, const vector<int>&); \
+template Hypergraph<W>* SeiveByNodeDegree(const Hypergraph<W>*, const Density<W>); \
+template Hypergraph<W>* SeiveByNodeDegree(const Hypergraph<W>*, const PeelingOrder<W>&, const Density<W>);
+
+FOR_EACH_WEIGHT_TYPE(INSTANTIATE_ALGORITHMS)
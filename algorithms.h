@@ -10,33 +10,155 @@
 #define __ALGORITHMS__
 
 #include "hypergraph.h"
+#include "checkpoint.h"
 
-Hypergraph* TryRemove(const int, const Hypergraph*, const ld);
+/**********TwinContraction**********/
 
-Hypergraph* TryEnhance(const int, const Hypergraph*, const ld);
+/*
+ * Nodes with the same incident edges are in or out of every densest
+ * subgraph together, since an edge holding one of them holds all. Each
+ * class of such twins becomes one node, named by its smallest id and
+ * weighing the sum of the class, which keeps every density; the exact
+ * solvers run on the contracted graph and Expand maps a result back.
+ * Unweighted graphs cannot weigh a class and are left as they are, and
+ * nodes without edges are never merged.
+ */
+template<class W>
+class TwinContraction{
+
+private:
+const Hypergraph<W>* graph_;
+Hypergraph<W>* contracted_;
+HashMap<int, vector<int> > twins_;
+int number_of_twins_;
+
+public:
+TwinContraction(const Hypergraph<W>*);
+~TwinContraction();
+const Hypergraph<W>* get_graph() const;
+int get_number_of_twins() const;
+Hypergraph<W>* Expand(Hypergraph<W>*) const;
+
+};
+
+/**********PeelingOrder**********/
+
+/*
+ * One greedy peeling of a graph: the nodes in order of removal, the degree
+ * of each when removed and the density of the suffix it heads. Every
+ * subgraph the peeling yields is a suffix: the greedy subgraph is the
+ * densest one, and the nodes of core number at least rho (the running
+ * maximum of the degrees) are the suffix from the first degree of at least
+ * rho, which is what sieving by rho keeps. A graph with a compressed
+ * incidence is peeled on it instead of on a copy of the graph.
+ */
+template<class W>
+class PeelingOrder{
+
+private:
+vector<int> node_ids_;
+vector<Density<W> > degrees_;
+vector<Density<W> > densities_;
+vector<Density<W> > core_numbers_;
+int densest_position_;
+Density<W> max_degree_;
+void Peel(const Hypergraph<W>*);
+void Peel(const Hypergraph<W>*, const CompressedIncidence<W>&);
+
+public:
+PeelingOrder(const Hypergraph<W>*);
+int get_number_of_nodes() const;
+int get_node_id(const int) const;
+Density<W> get_degree(const int) const;
+Density<W> get_density(const int) const;
+Density<W> get_core_number(const int) const;
+int get_densest_position() const;
+int get_core_position(const Density<W>) const;
+Density<W> get_greedy_density() const;
+Density<W> get_upper_bound() const;
+DensityBounds<W> get_density_bounds() const;
+vector<int> GetSuffix(const int) const;
+void GetCoreNumbers(HashMap<int, Density<W> >&) const;
+Hypergraph<W>* GenerateSuffix(const Hypergraph<W>*, const int) const;
+
+};
+
+template<class W>
+Hypergraph<W>* TryRemove(const int, const Hypergraph<W>*, const Density<W>, const TimeBudget& = TimeBudget());
+
+template<class W>
+Hypergraph<W>* TryEnhance(const int, const Hypergraph<W>*, const Density<W>, const TimeBudget& = TimeBudget());
 
-Hypergraph* FindMinimal(const Hypergraph*);
+template<class W>
+Hypergraph<W>* FindMinimal(const Hypergraph<W>*);
 
-vector<Hypergraph*> FindAllMinimal(const Hypergraph*);
+template<class W>
+Hypergraph<W>* FindMinimal(const Hypergraph<W>*, const DensityBounds<W>&, const TimeBudget&, bool&, const PeelingOrder<W>* = nullptr);
+
+template<class W>
+vector<Hypergraph<W>*> FindAllMinimal(const Hypergraph<W>*);
 
 // vector<Hypergraph*> ApproxMinAndRemove(const Hypergraph*, const int, const ld, const bool);
 
-vector<Hypergraph*> ApproxMinAndRemove(const Hypergraph*, const int, const ld, const bool, const int way_to_remove_nodes, Output&);
+/*
+ * The rounds given in prefix are replayed as induced subgraphs instead of
+ * being recomputed, e.g. from a result cache. A checkpoint, if given, is
+ * restored before the first round and recorded after every round.
+ */
+template<class W>
+vector<Hypergraph<W>*> ApproxMinAndRemove(const Hypergraph<W>*, const int, const double, const bool, const int way_to_remove_nodes, Output&, const vector<vector<int> >& prefix = vector<vector<int> >(), Checkpoint* checkpoint = nullptr);
+
+template<class W>
+vector<Hypergraph<W>*> AnytimeMinAndRemove(const Hypergraph<W>*, const int, const double, const int way_to_remove_nodes, const TimeBudget&, vector<Density<W> >&, Output&);
+
+template<class W>
+Hypergraph<W>* GreedyAlgorithm(const Hypergraph<W>*);
+
+template<class W>
+Hypergraph<W>* GreedyAlgorithm(const Hypergraph<W>*, Density<W>&);
+
+template<class W>
+Hypergraph<W>* GreedyAlgorithm(const Hypergraph<W>*, const PeelingOrder<W>&);
+
+/*
+ * Drops nodes whose degree cannot reach rho_apx in any subgraph; every
+ * subgraph at least as dense as rho_apx survives.
+ */
+template<class W>
+Hypergraph<W>* SeiveByNodeDegree(const Hypergraph<W>*, const Density<W>);
+
+/* The same sieve read off a peeling of the graph, without peeling again. */
+template<class W>
+Hypergraph<W>* SeiveByNodeDegree(const Hypergraph<W>*, const PeelingOrder<W>&, const Density<W>);
+
+template<class W>
+Hypergraph<W>* GenerateInducedSubgraph(const Hypergraph<W>*, const vector<int>&);
+
+template<class W>
+void NodesRemovalForLimitedOverlap(const Hypergraph<W>*, Hypergraph<W>*, const double, const int way_to_remove_nodes);
 
 namespace NaiveAlgorithm{
-    Hypergraph* FindDensestByDp(const Hypergraph*);
-    vector<Hypergraph*> NaiveApprox(const Hypergraph*, const int, Output&);
-    vector<Hypergraph*> NaiveDensest(const Hypergraph*, const int, Output&);
+    template<class W>
+    Hypergraph<W>* FindDensestByDp(const Hypergraph<W>*);
+    template<class W>
+    vector<Hypergraph<W>*> NaiveApprox(const Hypergraph<W>*, const int, Output&, const vector<vector<int> >& prefix = vector<vector<int> >(), Checkpoint* checkpoint = nullptr);
+    template<class W>
+    vector<Hypergraph<W>*> NaiveDensest(const Hypergraph<W>*, const int, Output&, const vector<vector<int> >& prefix = vector<vector<int> >(), Checkpoint* checkpoint = nullptr);
 }
 
 namespace UniquenessAlgorithm{
-    Hypergraph* FindDensestSubgraph(const Hypergraph*);
-    bool CheckByFindMinimal(const Hypergraph*, Hypergraph*&);
-    bool CheckByPruning(const Hypergraph*, const set, const ld);
-    bool Check(const Hypergraph*);
+    template<class W>
+    Hypergraph<W>* FindDensestSubgraph(const Hypergraph<W>*);
+    template<class W>
+    bool CheckByFindMinimal(const Hypergraph<W>*, Hypergraph<W>*&);
+    template<class W>
+    bool CheckByPruning(const Hypergraph<W>*, const set, const Density<W>);
+    template<class W>
+    bool Check(const Hypergraph<W>*);
 }
 
-bool CheckUniqueness(const Hypergraph*);
+template<class W>
+bool CheckUniqueness(const Hypergraph<W>*);
 
 // #include "algorithms.cc"
 
@@ -0,0 +1,260 @@
+/*
+ *
+ * For paper 'Finding Subgraphs with Maximum Total Density and Limited Overlap in Weighted Hypergraphs'
+ *
+ * Copyright reserved.
+ *
+ */
+
+#include "utility.h"
+#include "kernels.h"
+#include "hypergraph.h"
+#include "lp_algorithms.h"
+
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+string info = R"(
+The benchmark takes 4 optional arguments:
+- the number of elements per array, where the default is 4194304;
+- the number of repetitions, where the default is 50;
+- the location of a nodes file and of a hypergraph file to peel under every reordering, to compress and to solve the LP of, where the default is a synthetic hypergraph with one node per 64 elements whose ids are shuffled.
+)";
+
+template<class F>
+double Measure(const int repetitions, F f){
+    auto time_start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < repetitions; ++i){
+        f();
+    }
+    auto time_end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double>(time_end - time_start).count() / repetitions;
+}
+
+void Report(const string name, const double scalar_time, const double simd_time){
+    Console::Show(name + ": scalar " + Double2String(scalar_time * 1e3) + " ms, " + Kernels::get_simd_name() + " " + Double2String(simd_time * 1e3) + " ms, speedup " + Double2String(scalar_time / simd_time) + "x.");
+}
+
+/*
+ * Hardware cache misses of the calling thread, where the kernel allows
+ * perf events; otherwise every count is -1.
+ */
+class CacheMissCounter{
+
+private:
+int descriptor_;
+
+public:
+CacheMissCounter(){
+    perf_event_attr attribute;
+    std::memset(&attribute, 0, sizeof(attribute));
+    attribute.type = PERF_TYPE_HARDWARE;
+    attribute.size = sizeof(attribute);
+    attribute.config = PERF_COUNT_HW_CACHE_MISSES;
+    attribute.disabled = 1;
+    attribute.exclude_kernel = 1;
+    attribute.exclude_hv = 1;
+    descriptor_ = syscall(__NR_perf_event_open, &attribute, 0, -1, -1, 0);
+}
+~CacheMissCounter(){
+    if(descriptor_ >= 0){
+        close(descriptor_);
+    }
+}
+void Start(){
+    if(descriptor_ >= 0){
+        ioctl(descriptor_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(descriptor_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+long long Stop(){
+    long long count = -1;
+    if(descriptor_ >= 0){
+        ioctl(descriptor_, PERF_EVENT_IOC_DISABLE, 0);
+        if(read(descriptor_, &count, sizeof(count)) != sizeof(count)){
+            count = -1;
+        }
+    }
+    return count;
+}
+
+};
+
+/*
+ * Nodes sit on a hidden line and every edge picks its pins near a random
+ * point of it, so the graph has locality that shuffled ids hide.
+ */
+void WriteSyntheticHypergraph(const int n, const string node_file, const string edge_file){
+    vector<int> ids(n);
+    for(int i = 0; i < n; ++i){
+        ids[i] = i;
+    }
+    std::shuffle(ids.begin(), ids.end(), get_random_engine());
+    Output nodes(node_file.c_str()), edges(edge_file.c_str());
+    for(int i = 0; i < n; ++i){
+        nodes.Print(Int2String(ids[i]) + " " + Int2String(1 + get_random_value(0, 5)) + "\n");
+    }
+    for(int j = 0; j < 4 * n; ++j){
+        int center = get_random_value(0, n);
+        int size = 2 + get_random_value(0, 6);
+        string line;
+        for(int k = 0; k < size; ++k){
+            int v = std::min(n - 1, std::max(0, center + get_random_value(0, 64) - 32));
+            line += (k == 0 ? "" : ",") + Int2String(ids[v]);
+        }
+        edges.Print(line + " " + Int2String(1 + get_random_value(0, 10)) + "\n");
+    }
+}
+
+/*
+ * Greedy peeling of the whole graph, which is what HypergraphWithHeap
+ * spends its time on, under every reordering.
+ */
+void BenchmarkReordering(const string node_file, const string edge_file){
+    Hypergraph<double>* g = new Hypergraph<double>(node_file.c_str(), edge_file.c_str());
+    Console::Show("Peeling " + Int2String(g->get_number_of_nodes()) + " nodes and " + Int2String(g->get_number_of_edges()) + " edges.");
+    CacheMissCounter counter;
+    for(const string way:{"none", "degree", "bfs", "rcm"}){
+        auto time_start = std::chrono::high_resolution_clock::now();
+        Hypergraph<double>* h = way == "none" ? new Hypergraph<double>(*g) : g->GenerateReordering(way);
+        auto time_end = std::chrono::high_resolution_clock::now();
+        double seconds_of_reordering = std::chrono::duration<double>(time_end - time_start).count();
+        HypergraphWithHeap<double>* s = new HypergraphWithHeap<double>(*h);
+        counter.Start();
+        time_start = std::chrono::high_resolution_clock::now();
+        while(s->get_number_of_nodes() > 0){
+            s->Pop();
+        }
+        time_end = std::chrono::high_resolution_clock::now();
+        long long misses = counter.Stop();
+        Console::Show("Reordering " + way + ": built in " + Double2String(seconds_of_reordering * 1e3) + " ms, peeled in " + Double2String(std::chrono::duration<double>(time_end - time_start).count() * 1e3) + " ms, " + (misses < 0 ? string("cache misses unavailable") : std::to_string(misses) + " cache misses") + ".");
+        delete s;
+        delete h;
+    }
+    delete g;
+}
+
+/*
+ * Size of the pin lists as plain ints and as CompressedPinLists, and the
+ * time to read every pin back.
+ */
+void BenchmarkCompression(const string node_file, const string edge_file, const int repetitions){
+    Hypergraph<double>* g = new Hypergraph<double>(node_file.c_str(), edge_file.c_str());
+    vector<vector<int> > pins;
+    CompressedPinLists compressed_pins;
+    vector<double> weights;
+    g->GetEdges(pins, weights);
+    g->GetEdges(compressed_pins, weights);
+    delete g;
+    long long bytes = 0;
+    for(const auto& x:pins){
+        bytes += x.size() * sizeof(int) + sizeof(int64_t);
+    }
+    volatile long long sink = 0;
+    double plain_time = Measure(repetitions, [&](){
+        long long sum = 0;
+        for(const auto& x:pins){
+            for(const auto& v:x){
+                sum += v;
+            }
+        }
+        sink = sum;
+    });
+    double compressed_time = Measure(repetitions, [&](){
+        long long sum = 0;
+        for(int j = 0; j < compressed_pins.get_number_of_lists(); ++j){
+            for(const auto& v:compressed_pins[j]){
+                sum += v;
+            }
+        }
+        sink = sum;
+    });
+    double number_of_pins = compressed_pins.get_number_of_values();
+    Console::Show("Pins: plain " + std::to_string(bytes) + " bytes read at " + Double2String(number_of_pins / plain_time / 1e6) + "M pins/s, compressed " + std::to_string(compressed_pins.get_bytes()) + " bytes (ratio " + Double2String((double)bytes / compressed_pins.get_bytes()) + ") decoded at " + Double2String(number_of_pins / compressed_time / 1e6) + "M pins/s.");
+}
+
+/*
+ * One BasicLp on the whole hypergraph with every backend of this build.
+ */
+void BenchmarkLp(const string node_file, const string edge_file){
+    Hypergraph<double>* g = new Hypergraph<double>(node_file.c_str(), edge_file.c_str());
+    #ifdef WITHOUTGUROBI
+    vector<string> backends = {"flow"};
+    #else
+    vector<string> backends = {"gurobi", "flow"};
+    #endif // WITHOUTGUROBI
+    LpAlgorithm<double> lp_algorithm;
+    for(const auto& backend:backends){
+        LpSolver<double>::set_backend(backend);
+        auto time_start = std::chrono::high_resolution_clock::now();
+        Hypergraph<double>* h = lp_algorithm.BasicLp(g, true);
+        auto time_end = std::chrono::high_resolution_clock::now();
+        Console::Show("BasicLp with " + backend + ": density " + Double2String(h->get_density()) + " in " + Double2String(std::chrono::duration<double>(time_end - time_start).count() * 1e3) + " ms.");
+        delete h;
+    }
+    delete g;
+}
+
+int main(const int argc, const char* argv[]){
+    int n = 1 << 22;
+    int repetitions = 50;
+    string node_file, edge_file;
+    switch(argc){
+        case 5:
+            node_file = argv[3];
+            edge_file = argv[4];
+            // fall through
+        case 3:
+            repetitions = String2Int(argv[2]);
+            // fall through
+        case 2:
+            n = String2Int(argv[1]);
+        case 1:
+            break;
+        default:
+            Console::Error(info);
+    }
+
+    vector<double> weights(n), weights_of_edges(n), degrees(n);
+    vector<int> indices(n);
+    for(int i = 0; i < n; ++i){
+        weights[i] = 1 + get_random_value(0, 100) / 10.0;
+        weights_of_edges[i] = get_random_value(0, 1000) / 10.0;
+    }
+    Console::Show("Kernels on " + Int2String(n) + " doubles, " + Int2String(repetitions) + " repetitions.");
+
+    volatile double sink = 0;
+    Report("BatchDegree",
+        Measure(repetitions, [&](){ Kernels::Scalar::BatchDegree(weights_of_edges.data(), weights.data(), n, degrees.data()); }),
+        Measure(repetitions, [&](){ Kernels::BatchDegree(weights_of_edges.data(), weights.data(), n, degrees.data()); }));
+    Report("FilterBelow",
+        Measure(repetitions, [&](){ sink = Kernels::Scalar::FilterBelow(degrees.data(), n, 10.0, indices.data()); }),
+        Measure(repetitions, [&](){ sink = Kernels::FilterBelow(degrees.data(), n, 10.0, indices.data()); }));
+    Report("MaxValue",
+        Measure(repetitions, [&](){ sink = Kernels::Scalar::MaxValue(degrees.data(), n); }),
+        Measure(repetitions, [&](){ sink = Kernels::MaxValue(degrees.data(), n); }));
+
+    if(node_file.empty()){
+        char directory[] = "/tmp/dslo_benchmark_XXXXXX";
+        if(mkdtemp(directory) == nullptr){
+            Console::Error("Can't create a temporary directory!");
+        }
+        node_file = string(directory) + "/nodes";
+        edge_file = string(directory) + "/edges";
+        WriteSyntheticHypergraph(std::max(n / 64, 2), node_file, edge_file);
+        BenchmarkReordering(node_file, edge_file);
+        BenchmarkCompression(node_file, edge_file, repetitions);
+        BenchmarkLp(node_file, edge_file);
+        unlink(node_file.c_str());
+        unlink(edge_file.c_str());
+        rmdir(directory);
+    }else{
+        BenchmarkReordering(node_file, edge_file);
+        BenchmarkCompression(node_file, edge_file, repetitions);
+        BenchmarkLp(node_file, edge_file);
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+/*
+ *
+ * For paper 'Finding Subgraphs with Maximum Total Density and Limited Overlap in Weighted Hypergraphs'
+ *
+ * Copyright reserved.
+ *
+ */
+
+#include "cache.h"
+
+#include <cstdio>
+#include <atomic>
+#include <iomanip>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**********ResultCache**********/
+
+/*
+ * 64-bit FNV-1a over the bytes of both files.
+ */
+string ResultCache::Fingerprint(const string node_file, const string edge_file){
+    uint64_t hash = 14695981039346656037ULL;
+    char buff[1 << 16];
+    for(const auto& path:{node_file, edge_file}){
+        std::ifstream file(path, std::ios::binary);
+        if(!file.is_open()){
+            Console::Error("Cannot open <" + path + ">.");
+        }
+        while(file.read(buff, sizeof(buff)) || file.gcount() > 0){
+            for(std::streamsize i = 0; i < file.gcount(); ++i){
+                hash = (hash ^ (unsigned char)buff[i]) * 1099511628211ULL;
+            }
+        }
+        hash = (hash ^ 0xff) * 1099511628211ULL;
+    }
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return ss.str();
+}
+
+ResultCache::ResultCache(const string directory, const string key){
+    mkdir(directory.c_str(), 0755);
+    path_ = directory + "/" + key;
+}
+
+string ResultCache::get_path() const{
+    return path_;
+}
+
+/*
+ * Each line is one round: its density followed by its node ids. A last
+ * line "engine <state>" holds the random engine after the last round.
+ */
+bool ResultCache::Load(vector<vector<int> >& rounds, vector<double>& densities, string& random_state) const{
+    rounds.clear();
+    densities.clear();
+    random_state.clear();
+    std::ifstream file(path_);
+    if(!file.is_open()){
+        return false;
+    }
+    string line;
+    while(std::getline(file, line)){
+        if(line.compare(0, 7, "engine ") == 0){
+            random_state = line.substr(7);
+            break;
+        }
+        std::stringstream ss(line);
+        double density;
+        if(!(ss >> density)){
+            break;
+        }
+        vector<int> nodes;
+        int node_id;
+        while(ss >> node_id){
+            nodes.push_back(node_id);
+        }
+        rounds.push_back(nodes);
+        densities.push_back(density);
+    }
+    return !rounds.empty();
+}
+
+/*
+ * Written to a temporary file first, so concurrent runs never see a
+ * partial cache.
+ */
+void ResultCache::Save(const vector<vector<int> >& rounds, const vector<double>& densities, const string random_state) const{
+    static std::atomic<int> number_of_saves(0);
+    string temp_path = path_ + ".tmp" + Int2String(getpid()) + "_" + Int2String(number_of_saves++);
+    {
+        std::ofstream file(temp_path);
+        file << std::setprecision(17);
+        for(int i = 0; i < (int)rounds.size(); ++i){
+            file << densities[i];
+            for(const auto& node_id:rounds[i]){
+                file << " " << node_id;
+            }
+            file << "\n";
+        }
+        file << "engine " << random_state << "\n";
+        if(!file.good()){
+            Console::Log("Cannot write cache <" + temp_path + ">.");
+            remove(temp_path.c_str());
+            return;
+        }
+    }
+    rename(temp_path.c_str(), path_.c_str());
+}
@@ -0,0 +1,40 @@
+/*
+ *
+ * For paper 'Finding Subgraphs with Maximum Total Density and Limited Overlap in Weighted Hypergraphs'
+ *
+ * Copyright reserved.
+ *
+ */
+
+#ifndef __CACHE__
+#define __CACHE__
+
+#include "macro.h"
+#include "utility.h"
+
+/**********ResultCache**********/
+
+/*
+ * Rounds of earlier runs kept on disk, one file per graph fingerprint and
+ * parameter set without k. Every algorithm extracts its rounds in order,
+ * so the rounds of a run with a smaller k are a prefix of a larger one.
+ * The random engine after the last round is kept too, so a run going on
+ * past the cached rounds draws what a fresh run would.
+ */
+class ResultCache{
+
+private:
+string path_;
+
+public:
+static string Fingerprint(const string, const string);
+ResultCache(const string, const string);
+string get_path() const;
+bool Load(vector<vector<int> >&, vector<double>&, string&) const;
+void Save(const vector<vector<int> >&, const vector<double>&, const string) const;
+
+};
+
+// #include "cache.cc"
+
+#endif // __CACHE__
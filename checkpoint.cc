@@ -0,0 +1,149 @@
+/*
+ *
+ * For paper 'Finding Subgraphs with Maximum Total Density and Limited Overlap in Weighted Hypergraphs'
+ *
+ * Copyright reserved.
+ *
+ */
+
+#include "checkpoint.h"
+#include "algorithms.h"
+
+#include <cctype>
+#include <cstdio>
+
+/**********Checkpoint**********/
+
+Checkpoint::Checkpoint(const string path, const string fingerprint): path_(path), fingerprint_(fingerprint), output_size_(0), elapsed_(0), is_loaded_(false), start_(std::chrono::steady_clock::now()){}
+
+/*
+ * Layout, one item per line: the fingerprint, the number of rounds, the
+ * output size, the elapsed seconds, the removed-node bitset in hex, the
+ * random engine state, and then one line of node ids per round.
+ */
+bool Checkpoint::Load(){
+    std::ifstream file(path_);
+    if(!file.is_open()){
+        return false;
+    }
+    string fingerprint, bitset;
+    int number_of_rounds = 0;
+    if(!(std::getline(file, fingerprint) && file >> number_of_rounds >> output_size_ >> elapsed_ >> bitset) || fingerprint != fingerprint_){
+        Console::Show("Ignoring checkpoint <" + path_ + "> of another run.");
+        return false;
+    }
+    removed_nodes_.clear();
+    for(int i = 0; i < (int)bitset.length(); ++i){
+        int digit = isdigit(bitset[i]) ? bitset[i] - '0' : bitset[i] - 'a' + 10;
+        for(int j = 0; j < 4; ++j){
+            if(digit >> j & 1){
+                removed_nodes_.push_back(i * 4 + j);
+            }
+        }
+    }
+    file.ignore();
+    std::getline(file, random_state_);
+    rounds_.assign(number_of_rounds, vector<int>());
+    for(auto& x:rounds_){
+        string line;
+        std::getline(file, line);
+        std::stringstream ss(line);
+        int node_id;
+        while(ss >> node_id){
+            x.push_back(node_id);
+        }
+    }
+    start_ = std::chrono::steady_clock::now();
+    is_loaded_ = true;
+    return true;
+}
+
+int Checkpoint::get_number_of_rounds() const{
+    return rounds_.size();
+}
+
+long long Checkpoint::get_output_size() const{
+    return output_size_;
+}
+
+double Checkpoint::get_elapsed() const{
+    return elapsed_;
+}
+
+/*
+ * Brings a fresh copy h of the base graph g and an empty list l to the
+ * state after the checkpointed rounds; does nothing unless a checkpoint
+ * was loaded.
+ */
+template<class W>
+void Checkpoint::Restore(const Hypergraph<W>* g, Hypergraph<W>* h, vector<Hypergraph<W>*>& l) const{
+    if(!is_loaded_){
+        return;
+    }
+    set node_set = g->get_node_set();
+    vector<int> node_ids(node_set.begin(), node_set.end());
+    std::sort(node_ids.begin(), node_ids.end());
+    set node_set_to_be_deleted;
+    for(const auto& x:removed_nodes_){
+        node_set_to_be_deleted.insert(node_ids[x]);
+    }
+    h->RemoveNodeSet(node_set_to_be_deleted);
+    for(const auto& x:rounds_){
+        l.push_back(GenerateInducedSubgraph(g, x));
+    }
+    std::stringstream ss(random_state_);
+    ss >> get_random_engine();
+    Console::Show("Resuming after round " + Int2String(l.size()) + " from <" + path_ + ">.");
+}
+
+/*
+ * Written to a temporary file first, so a crash while saving keeps the
+ * previous checkpoint.
+ */
+template<class W>
+void Checkpoint::Record(const Hypergraph<W>* g, const Hypergraph<W>* h, const vector<Hypergraph<W>*>& l, Output& output){
+    set node_set = g->get_node_set();
+    vector<int> node_ids(node_set.begin(), node_set.end());
+    std::sort(node_ids.begin(), node_ids.end());
+    vector<int> digits((node_ids.size() + 3) / 4, 0);
+    for(int i = 0; i < (int)node_ids.size(); ++i){
+        if(!h->has_node(node_ids[i])){
+            digits[i / 4] |= 1 << (i % 4);
+        }
+    }
+    string bitset = digits.empty() ? "0" : "";
+    for(const auto& x:digits){
+        bitset += "0123456789abcdef"[x];
+    }
+    double seconds = elapsed_ + std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    string temp_path = path_ + ".tmp";
+    {
+        std::ofstream file(temp_path);
+        file << fingerprint_ << "\n" << l.size() << " " << output.get_size() << " " << Double2String(seconds) << " " << bitset << "\n";
+        file << get_random_engine() << "\n";
+        for(const auto& x:l){
+            set nodes = x->get_node_set();
+            vector<int> sorted_nodes(nodes.begin(), nodes.end());
+            std::sort(sorted_nodes.begin(), sorted_nodes.end());
+            for(int i = 0; i < (int)sorted_nodes.size(); ++i){
+                file << (i == 0 ? "" : " ") << sorted_nodes[i];
+            }
+            file << "\n";
+        }
+        if(!file.good()){
+            Console::Log("Cannot write checkpoint <" + temp_path + ">.");
+            return;
+        }
+    }
+    rename(temp_path.c_str(), path_.c_str());
+}
+
+void Checkpoint::Remove() const{
+    remove(path_.c_str());
+}
+
+#define INSTANTIATE_CHECKPOINT(W) \
+template void Checkpoint::Restore(const Hypergraph<W>*, Hypergraph<W>*, vector<Hypergraph<W>*>&) const; \
+template void Checkpoint::Record(const Hypergraph<W>*, const Hypergraph<W>*, const vector<Hypergraph<W>*>&, Output&);
+
+FOR_EACH_WEIGHT_TYPE(INSTANTIATE_CHECKPOINT)
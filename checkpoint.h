@@ -0,0 +1,50 @@
+/*
+ *
+ * For paper 'Finding Subgraphs with Maximum Total Density and Limited Overlap in Weighted Hypergraphs'
+ *
+ * Copyright reserved.
+ *
+ */
+
+#ifndef __CHECKPOINT__
+#define __CHECKPOINT__
+
+#include "hypergraph.h"
+
+/**********Checkpoint**********/
+
+/*
+ * State of a round loop after its latest round: the residual graph as a
+ * bitset of removed nodes over the sorted node ids of the base graph, the
+ * extracted node sets, the random engine, the length of the output file
+ * and the elapsed time. The file is rewritten after every round and tagged
+ * with a fingerprint of the run, so a checkpoint of another run is ignored.
+ */
+class Checkpoint{
+
+private:
+string path_;
+string fingerprint_;
+vector<vector<int> > rounds_;
+vector<int> removed_nodes_;
+string random_state_;
+long long output_size_;
+double elapsed_;
+bool is_loaded_;
+std::chrono::steady_clock::time_point start_;
+
+public:
+Checkpoint(const string, const string);
+bool Load();
+int get_number_of_rounds() const;
+long long get_output_size() const;
+double get_elapsed() const;
+template<class W> void Restore(const Hypergraph<W>*, Hypergraph<W>*, vector<Hypergraph<W>*>&) const;
+template<class W> void Record(const Hypergraph<W>*, const Hypergraph<W>*, const vector<Hypergraph<W>*>&, Output&);
+void Remove() const;
+
+};
+
+// #include "checkpoint.cc"
+
+#endif // __CHECKPOINT__
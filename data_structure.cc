@@ -7,8 +7,10 @@
  */
 
 #include "data_structure.h"
+#include "utility.h"
 
-void Heap::wash(){
+template<class K>
+void Heap<K>::wash(){
     while(!heap.empty()){
         auto x = heap.top();
         auto p = iterator.find(x.second.first);
@@ -20,29 +22,319 @@ void Heap::wash(){
     }
 }
 
-void Heap::push(const int key, const ld value){
+template<class K>
+void Heap<K>::push(const int key, const K value){
     iterator[key] = std::make_pair(value, 0);
     heap.push(std::make_pair(value, std::make_pair(key, 0)));
 }
 
-int Heap::top(){
+template<class K>
+int Heap<K>::top(){
     wash();
     return heap.top().second.first;
 }
 
-void Heap::pop(){
+template<class K>
+void Heap<K>::pop(){
     int key = top();
     erase(key);
 }
 
-void Heap::modify(const int key, const ld value){
+template<class K>
+void Heap<K>::modify(const int key, const K value){
     auto p = iterator.find(key);
     p->second.first = value;
     p->second.second = p->second.second + 1;
     heap.push(std::make_pair(value, std::make_pair(key, p->second.second)));
 }
 
-void Heap::erase(const int key){
+template<class K>
+void Heap<K>::erase(const int key){
     auto p = iterator.find(key);
     iterator.erase(p);
-}
\ No newline at end of file
+}
+
+/**********BucketQueue**********/
+
+void BucketQueue::unlink(const int key){
+    auto p = iterator.find(key);
+    vector<int>& bucket = buckets[p->second.first];
+    int last = bucket.back();
+    bucket[p->second.second] = last;
+    iterator[last].second = p->second.second;
+    bucket.pop_back();
+}
+
+void BucketQueue::push(const int key, const int value){
+    if((int)buckets.size() <= value){
+        buckets.resize(value + 1);
+    }
+    if(iterator.empty() || value < minimum){
+        minimum = value;
+    }
+    iterator[key] = std::make_pair(value, (int)buckets[value].size());
+    buckets[value].push_back(key);
+}
+
+int BucketQueue::top(){
+    while(buckets[minimum].empty()){
+        ++minimum;
+    }
+    return buckets[minimum].back();
+}
+
+void BucketQueue::pop(){
+    erase(top());
+}
+
+void BucketQueue::modify(const int key, const int value){
+    unlink(key);
+    iterator.erase(key);
+    push(key, value);
+}
+
+void BucketQueue::erase(const int key){
+    unlink(key);
+    iterator.erase(key);
+}
+
+/**********Arena**********/
+
+Arena::Arena(const size_t block_size, const char* category): block_size_(block_size), category_(category), used_(0){}
+
+Arena::~Arena(){
+    Release();
+    for(auto& x:spare_blocks_){
+        MemoryTracker::Release(category_, x.second);
+        delete[] x.first;
+    }
+    spare_blocks_.clear();
+}
+
+void Arena::AddBlock(const size_t bytes){
+    for(int i = 0; i < (int)spare_blocks_.size(); ++i){
+        if(spare_blocks_[i].second >= bytes){
+            blocks_.push_back(spare_blocks_[i]);
+            spare_blocks_.erase(spare_blocks_.begin() + i);
+            used_ = 0;
+            return;
+        }
+    }
+    size_t size = block_size_;
+    if(!blocks_.empty()){
+        size = std::max(size, blocks_.back().second * 2);
+    }
+    size = std::max(size, bytes);
+    MemoryTracker::Charge(category_, size);
+    blocks_.push_back(std::make_pair(new char[size], size));
+    used_ = 0;
+}
+
+void* Arena::Allocate(const size_t bytes, const size_t alignment){
+    if(!blocks_.empty()){
+        size_t offset = (used_ + alignment - 1) / alignment * alignment;
+        if(offset + bytes <= blocks_.back().second){
+            used_ = offset + bytes;
+            return blocks_.back().first + offset;
+        }
+    }
+    AddBlock(bytes + alignment);
+    size_t offset = (reinterpret_cast<size_t>(blocks_.back().first) + alignment - 1) / alignment * alignment - reinterpret_cast<size_t>(blocks_.back().first);
+    used_ = offset + bytes;
+    return blocks_.back().first + offset;
+}
+
+void Arena::Release(){
+    for(auto& x:blocks_){
+        MemoryTracker::Release(category_, x.second);
+        delete[] x.first;
+    }
+    blocks_.clear();
+    used_ = 0;
+}
+
+Arena::Mark Arena::get_mark() const{
+    Mark mark;
+    mark.block = blocks_.size();
+    mark.used = used_;
+    return mark;
+}
+
+void Arena::Rewind(const Mark& mark){
+    while((int)blocks_.size() > mark.block){
+        spare_blocks_.push_back(blocks_.back());
+        blocks_.pop_back();
+    }
+    used_ = blocks_.empty() ? 0 : mark.used;
+}
+
+size_t Arena::get_bytes_reserved() const{
+    size_t ans = 0;
+    for(const auto& x:blocks_){
+        ans += x.second;
+    }
+    for(const auto& x:spare_blocks_){
+        ans += x.second;
+    }
+    return ans;
+}
+
+const char* Arena::get_category() const{
+    return category_;
+}
+
+/**********ScratchScope**********/
+
+Arena& ScratchScope::get_arena(){
+    static thread_local Arena arena(1 << 20, "scratch");
+    return arena;
+}
+
+ScratchScope::ScratchScope(): mark_(get_arena().get_mark()){}
+
+ScratchScope::~ScratchScope(){
+    get_arena().Rewind(mark_);
+}
+
+/**********CsrGraph**********/
+
+CsrGraph::CsrGraph(): offsets_(1, 0){}
+
+CsrGraph::CsrGraph(vector<int64_t>&& offsets, vector<int>&& targets, vector<int>&& vertex_ids): offsets_(std::move(offsets)), targets_(std::move(targets)), vertex_ids_(std::move(vertex_ids)){}
+
+int CsrGraph::get_number_of_vertices() const{
+    return vertex_ids_.size();
+}
+
+int64_t CsrGraph::get_number_of_arcs() const{
+    return targets_.size();
+}
+
+int CsrGraph::get_degree(const int v) const{
+    return offsets_[v + 1] - offsets_[v];
+}
+
+const int* CsrGraph::get_neighbors_begin(const int v) const{
+    return targets_.data() + offsets_[v];
+}
+
+const int* CsrGraph::get_neighbors_end(const int v) const{
+    return targets_.data() + offsets_[v + 1];
+}
+
+int CsrGraph::get_vertex_id(const int v) const{
+    return vertex_ids_[v];
+}
+
+/**********CompressedPinLists**********/
+
+static inline void PutVarint(uint32_t value, vector<uint8_t>& bytes){
+    while(value >= 0x80){
+        bytes.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back((uint8_t)value);
+}
+
+static inline uint32_t GetVarint(const uint8_t*& position){
+    uint32_t value = *position & 0x7f;
+    for(int shift = 7; *position++ & 0x80; shift += 7){
+        value |= (uint32_t)(*position & 0x7f) << shift;
+    }
+    return value;
+}
+
+CompressedPinLists::Iterator::Iterator(): position_(nullptr), remaining_(0), value_(0){}
+
+CompressedPinLists::Iterator::Iterator(const uint8_t* list): position_(list), value_(0){
+    remaining_ = GetVarint(position_);
+    if(remaining_ > 0){
+        uint32_t first = GetVarint(position_);
+        value_ = (int)(first >> 1) ^ -(int)(first & 1);
+    }
+}
+
+int CompressedPinLists::Iterator::get_size() const{
+    return remaining_;
+}
+
+int CompressedPinLists::Iterator::operator*() const{
+    return value_;
+}
+
+CompressedPinLists::Iterator& CompressedPinLists::Iterator::operator++(){
+    if(--remaining_ > 0){
+        value_ += GetVarint(position_);
+    }
+    return *this;
+}
+
+bool CompressedPinLists::Iterator::operator!=(const Iterator& other) const{
+    return remaining_ != other.remaining_;
+}
+
+CompressedPinLists::Iterator CompressedPinLists::List::begin() const{
+    return first;
+}
+
+CompressedPinLists::Iterator CompressedPinLists::List::end() const{
+    return Iterator();
+}
+
+/*
+ * Appends the encoding of a sorted list; equal neighbours are kept as
+ * zero gaps.
+ */
+void CompressedPinLists::Encode(const vector<int>& values, vector<uint8_t>& bytes){
+    PutVarint(values.size(), bytes);
+    if(values.empty()){
+        return;
+    }
+    PutVarint(((uint32_t)values[0] << 1) ^ (uint32_t)(values[0] >> 31), bytes);
+    for(size_t i = 1; i < values.size(); ++i){
+        PutVarint((uint32_t)(values[i] - values[i - 1]), bytes);
+    }
+}
+
+CompressedPinLists::CompressedPinLists(): offsets_(1, 0), number_of_values_(0){}
+
+void CompressedPinLists::Append(const vector<int>& values){
+    if(std::is_sorted(values.begin(), values.end())){
+        Encode(values, bytes_);
+    }else{
+        vector<int> sorted_values(values);
+        std::sort(sorted_values.begin(), sorted_values.end());
+        Encode(sorted_values, bytes_);
+    }
+    offsets_.push_back(bytes_.size());
+    number_of_values_ += values.size();
+}
+
+void CompressedPinLists::ShrinkToFit(){
+    offsets_.shrink_to_fit();
+    bytes_.shrink_to_fit();
+}
+
+int CompressedPinLists::get_number_of_lists() const{
+    return offsets_.size() - 1;
+}
+
+int64_t CompressedPinLists::get_number_of_values() const{
+    return number_of_values_;
+}
+
+int64_t CompressedPinLists::get_bytes() const{
+    return bytes_.capacity() + offsets_.capacity() * sizeof(int64_t);
+}
+
+int CompressedPinLists::get_size(const int i) const{
+    const uint8_t* position = bytes_.data() + offsets_[i];
+    return GetVarint(position);
+}
+
+CompressedPinLists::List CompressedPinLists::operator[](const int i) const{
+    return List{Iterator(bytes_.data() + offsets_[i])};
+}
+
+template struct Heap<double>;
+template struct Heap<long double>;
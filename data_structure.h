@@ -12,8 +12,10 @@
 #include "macro.h"
 
 #include <unordered_map>
+#include <unordered_set>
 #include <map>
 #include <queue>
+#include <cstddef>
 
 template<class T1, class T2>
 using HashMap = std::unordered_map<T1, T2>;
@@ -21,18 +23,206 @@ using HashMap = std::unordered_map<T1, T2>;
 template<class T1, class T2>
 using Map = std::map<T1, T2>;
 
+template<class K>
 struct Heap{
-std::priority_queue<std::pair<ld, std::pair<ld, int> >, vector<std::pair<ld, std::pair<ld, int> > >, std::greater<std::pair<ld, std::pair<ld, int> > > > heap;
-HashMap<int, std::pair<ld, int> > iterator;
+std::priority_queue<std::pair<K, std::pair<int, int> >, vector<std::pair<K, std::pair<int, int> > >, std::greater<std::pair<K, std::pair<int, int> > > > heap;
+HashMap<int, std::pair<K, int> > iterator;
 void wash();
-void push(const int, const ld);
+void push(const int, const K);
 int top();
 void pop();
-void modify(const int, const ld);
+void modify(const int, const K);
 void erase(const int);
 };
 
 
+/*
+ * Heap over integer keys for unweighted peeling: one bucket per degree,
+ * O(1) push, modify and erase.
+ */
+struct BucketQueue{
+vector<vector<int> > buckets;
+HashMap<int, std::pair<int, int> > iterator;
+int minimum = 0;
+void unlink(const int);
+void push(const int, const int);
+int top();
+void pop();
+void modify(const int, const int);
+void erase(const int);
+};
+
+template<class W>
+struct PeelingQueue{
+using Type = Heap<Density<W> >;
+};
+
+template<>
+struct PeelingQueue<Unweighted>{
+using Type = BucketQueue;
+};
+
+/**********Arena**********/
+
+/*
+ * Monotonic allocator: memory is handed out from large blocks and only
+ * returned all at once, by Release() or by rewinding to a Mark. Blocks are
+ * charged to the memory tracker under the category of the arena.
+ */
+class Arena{
+public:
+struct Mark{
+int block;
+size_t used;
+};
+
+private:
+size_t block_size_;
+const char* category_;
+vector<std::pair<char*, size_t> > blocks_;
+vector<std::pair<char*, size_t> > spare_blocks_;
+size_t used_;
+void AddBlock(const size_t);
+
+public:
+Arena(const size_t = 1 << 16, const char* = "graph");
+Arena(const Arena&) = delete;
+Arena& operator=(const Arena&) = delete;
+~Arena();
+void* Allocate(const size_t, const size_t);
+void Release();
+Mark get_mark() const;
+void Rewind(const Mark&);
+size_t get_bytes_reserved() const;
+const char* get_category() const;
+};
+
+/**********ArenaAllocator**********/
+
+template<class T>
+class ArenaAllocator{
+template<class U> friend class ArenaAllocator;
+
+private:
+Arena* arena_;
+
+public:
+using value_type = T;
+ArenaAllocator(Arena* arena): arena_(arena){}
+template<class U>
+ArenaAllocator(const ArenaAllocator<U>& other): arena_(other.arena_){}
+T* allocate(const size_t n){
+    return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+}
+void deallocate(T*, const size_t){}
+Arena* get_arena() const{
+    return arena_;
+}
+template<class U>
+bool operator==(const ArenaAllocator<U>& other) const{
+    return arena_ == other.arena_;
+}
+template<class U>
+bool operator!=(const ArenaAllocator<U>& other) const{
+    return arena_ != other.arena_;
+}
+};
+
+using ArenaSet = std::unordered_set<int, std::hash<int>, std::equal_to<int>, ArenaAllocator<int> >;
+
+template<class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T> >;
+
+/**********ScratchScope**********/
+
+/*
+ * Per-thread arena for short-lived temporaries of one round; everything
+ * allocated from it inside a scope is dropped when the scope ends.
+ */
+class ScratchScope{
+private:
+Arena::Mark mark_;
+
+public:
+static Arena& get_arena();
+ScratchScope();
+ScratchScope(const ScratchScope&) = delete;
+~ScratchScope();
+template<class T>
+ArenaAllocator<T> get_allocator() const{
+    return ArenaAllocator<T>(&get_arena());
+}
+};
+
+/**********CsrGraph**********/
+
+/*
+ * Immutable simple graph in compressed sparse row form: the sorted
+ * neighbors of vertex v are targets[offsets[v] .. offsets[v+1]), and
+ * vertex_ids maps every vertex back to the id it was built from.
+ */
+class CsrGraph{
+private:
+vector<int64_t> offsets_;
+vector<int> targets_;
+vector<int> vertex_ids_;
+
+public:
+CsrGraph();
+CsrGraph(vector<int64_t>&&, vector<int>&&, vector<int>&&);
+int get_number_of_vertices() const;
+int64_t get_number_of_arcs() const;
+int get_degree(const int) const;
+const int* get_neighbors_begin(const int) const;
+const int* get_neighbors_end(const int) const;
+int get_vertex_id(const int) const;
+};
+
+/**********CompressedPinLists**********/
+
+/*
+ * Sorted integer lists (pin lists of edges) stored back to back as bytes:
+ * a list is its length, its first value zigzag-coded and the gaps between
+ * consecutive values, each a varint with 7 bits per byte and the high bit
+ * set on every byte but the last. A list is decoded in order by Iterator,
+ * which can also walk an encoded list held outside the container.
+ */
+class CompressedPinLists{
+private:
+vector<int64_t> offsets_;
+vector<uint8_t> bytes_;
+int64_t number_of_values_;
+
+public:
+class Iterator{
+private:
+const uint8_t* position_;
+int remaining_;
+int value_;
+
+public:
+Iterator();
+Iterator(const uint8_t*);
+int get_size() const;
+int operator*() const;
+Iterator& operator++();
+bool operator!=(const Iterator&) const;
+};
+struct List{
+Iterator first;
+Iterator begin() const;
+Iterator end() const;
+};
+static void Encode(const vector<int>&, vector<uint8_t>&);
+CompressedPinLists();
+void Append(const vector<int>&);
+void ShrinkToFit();
+int get_number_of_lists() const;
+int64_t get_number_of_values() const;
+int64_t get_bytes() const;
+int get_size(const int) const;
+List operator[](const int) const;
+};
 
 // #include "data_structure.cc"
 
@@ -0,0 +1,607 @@
+/*
+ *
+ * For paper 'Finding Subgraphs with Maximum Total Density and Limited Overlap in Weighted Hypergraphs'
+ *
+ * Copyright reserved.
+ *
+ */
+
+#include "dynamic.h"
+#include "algorithms.h"
+#include "macro.h"
+#include "utility.h"
+
+/**********TrackedSubgraph**********/
+
+template<class W>
+Density<W> TrackedSubgraph<W>::get_density() const{
+    if(cmp(weight_of_nodes, 0) == 0){
+        return 0;
+    }
+    return (Density<W>)weight_of_edges / weight_of_nodes;
+}
+
+bool IsInside(const set& nodes, const vector<int>& pins){
+    for(const auto& node_id:pins){
+        if(nodes.find(node_id) == nodes.end()){
+            return false;
+        }
+    }
+    return true;
+}
+
+/**********NodeLoad**********/
+
+template<class W>
+Density<W> NodeLoad<W>::get_load() const{
+    return weight > 0 ? held_weight / weight : 0;
+}
+
+/*
+ * Index of the share of node_id in the shares of an edge, or -1.
+ */
+template<class T>
+int FindShare(const vector<std::pair<int, T> >& shares, const int node_id){
+    for(int i = 0; i < (int)shares.size(); ++i){
+        if(shares[i].first == node_id){
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**********DynamicDensestSubgraph**********/
+
+template<class W>
+DynamicDensestSubgraph<W>::DynamicDensestSubgraph(DynamicHypergraph<W>* g, const double epsilon, const int k, const double alpha, const int way_to_remove_nodes): g_(g), epsilon_(epsilon), k_(std::max(k, 1)), alpha_(alpha), way_to_remove_nodes_(way_to_remove_nodes), scale_(0), width_(0), resolution_(1), max_resolution_(1), upper_bound_(0), number_of_updates_(0), number_of_recomputes_(0), number_of_exact_recomputes_(0), number_of_rebuilds_(0), number_of_moves_(0){
+    for(const auto& node_id:g_->get_node_set()){
+        AddLoad(node_id);
+    }
+    for(const auto& edge_id:g_->get_edge_ids()){
+        Assign(edge_id);
+    }
+    Rebuild();
+    Refresh();
+}
+
+template<class W>
+DynamicDensestSubgraph<W>::~DynamicDensestSubgraph(){
+    delete g_;
+}
+
+/*
+ * The largest load is in the top level.
+ */
+template<class W>
+Density<W> DynamicDensestSubgraph<W>::get_max_load() const{
+    Density<W> ans = 0;
+    if(!buckets_.empty()){
+        for(const auto& node_id:buckets_.rbegin()->second){
+            ans = std::max(ans, loads_.find(node_id)->second.get_load());
+        }
+    }
+    return ans;
+}
+
+template<class W>
+void DynamicDensestSubgraph<W>::AddLoad(const int node_id){
+    Weight<W> weight = g_->get_weight_of_node(node_id);
+    NodeLoad<W>& load = loads_[node_id];
+    load.weight = cmp(weight, 0) > 0 ? (Density<W>)weight : 0;
+    buckets_[0].insert(node_id);
+}
+
+/*
+ * Moves the node to the bucket of its load. A node whose level changed
+ * is queued to be checked against its edges: all of them when the level
+ * dropped, only those it holds a share of when it rose.
+ */
+template<class W>
+void DynamicDensestSubgraph<W>::Relevel(const int node_id, NodeLoad<W>& load){
+    long long level = width_ > 0 ? (long long)std::floor(load.get_load() / width_) : 0;
+    if(level == load.level){
+        return;
+    }
+    if(level < load.level){
+        is_lowered_.insert(node_id);
+    }
+    auto bucket = buckets_.find(load.level);
+    bucket->second.erase(node_id);
+    if(bucket->second.empty()){
+        buckets_.erase(bucket);
+    }
+    load.level = level;
+    buckets_[level].insert(node_id);
+    if(width_ > 0 && is_queued_.insert(node_id).second){
+        queue_.push_back(node_id);
+    }
+}
+
+/*
+ * Hands the weight of the edge to its least loaded pin. An edge whose
+ * pins all weigh 0 has no share, and the loads bound nothing while there
+ * is one.
+ */
+template<class W>
+void DynamicDensestSubgraph<W>::Assign(const int edge_id){
+    Weight<W> weight = g_->get_weight_of_edge(edge_id);
+    if(cmp(weight, 0) <= 0){
+        return;
+    }
+    int target = -1;
+    NodeLoad<W>* target_load = nullptr;
+    for(const auto& node_id:g_->get_nodes_of_edge(edge_id)){
+        NodeLoad<W>& load = loads_.find(node_id)->second;
+        if(load.weight > 0 && (target_load == nullptr || load.get_load() < target_load->get_load())){
+            target = node_id;
+            target_load = &load;
+        }
+    }
+    if(target_load == nullptr){
+        unbounded_edges_.insert(edge_id);
+        return;
+    }
+    shares_[edge_id].push_back(std::make_pair(target, (Density<W>)weight));
+    target_load->held_edges.insert(edge_id);
+    target_load->held_weight += (Density<W>)weight;
+    Relevel(target, *target_load);
+}
+
+template<class W>
+void DynamicDensestSubgraph<W>::Unassign(const int edge_id){
+    unbounded_edges_.erase(edge_id);
+    auto x = shares_.find(edge_id);
+    if(x == shares_.end()){
+        return;
+    }
+    vector<std::pair<int, Density<W> > > shares;
+    shares.swap(x->second);
+    shares_.erase(x);
+    for(const auto& share:shares){
+        NodeLoad<W>& load = loads_.find(share.first)->second;
+        load.held_edges.erase(edge_id);
+        load.held_weight = load.held_edges.empty() ? 0 : load.held_weight - share.second;
+        Relevel(share.first, load);
+    }
+}
+
+/*
+ * Moves weight of the edge from one pin to another, as much as the share
+ * of the first allows but no more than leaves the first 1.5 levels above
+ * the second.
+ */
+template<class W>
+void DynamicDensestSubgraph<W>::Move(const int edge_id, const int from, const int to){
+    vector<std::pair<int, Density<W> > >& shares = shares_[edge_id];
+    NodeLoad<W>& from_load = loads_.find(from)->second;
+    NodeLoad<W>& to_load = loads_.find(to)->second;
+    int i = FindShare(shares, from);
+    Density<W> delta = (from_load.get_load() - to_load.get_load() - 1.5 * width_) / (1 / from_load.weight + 1 / to_load.weight);
+    if(delta >= shares[i].second){
+        delta = shares[i].second;
+        shares.erase(shares.begin() + i);
+        from_load.held_edges.erase(edge_id);
+        from_load.held_weight = from_load.held_edges.empty() ? 0 : from_load.held_weight - delta;
+    }else{
+        shares[i].second -= delta;
+        from_load.held_weight -= delta;
+    }
+    int j = FindShare(shares, to);
+    if(j < 0){
+        shares.push_back(std::make_pair(to, delta));
+        to_load.held_edges.insert(edge_id);
+    }else{
+        shares[j].second += delta;
+    }
+    to_load.held_weight += delta;
+    ++number_of_moves_;
+    Relevel(from, from_load);
+    Relevel(to, to_load);
+}
+
+/*
+ * Moves the shares of the edge to its least loaded pin while a holder is
+ * three levels or more above that pin.
+ */
+template<class W>
+void DynamicDensestSubgraph<W>::Fix(const int edge_id){
+    auto x = shares_.find(edge_id);
+    if(x == shares_.end()){
+        return;
+    }
+    vector<int> pins = g_->get_nodes_of_edge(edge_id);
+    vector<const NodeLoad<W>*> pin_loads;
+    pin_loads.reserve(pins.size());
+    for(const auto& node_id:pins){
+        pin_loads.push_back(&loads_.find(node_id)->second);
+    }
+    while(true){
+        int lowest = -1, highest = -1;
+        for(int i = 0; i < (int)pins.size(); ++i){
+            if(pin_loads[i]->weight > 0 && (lowest < 0 || pin_loads[i]->get_load() < pin_loads[lowest]->get_load())){
+                lowest = i;
+            }
+            if(FindShare(x->second, pins[i]) >= 0 && (highest < 0 || pin_loads[i]->level > pin_loads[highest]->level)){
+                highest = i;
+            }
+        }
+        if(pin_loads[highest]->level < pin_loads[lowest]->level + 3){
+            return;
+        }
+        Move(edge_id, pins[highest], pins[lowest]);
+    }
+}
+
+template<class W>
+void DynamicDensestSubgraph<W>::Balance(){
+    while(!queue_.empty()){
+        int node_id = queue_.front();
+        queue_.pop_front();
+        is_queued_.erase(node_id);
+        bool is_lowered = is_lowered_.erase(node_id) > 0;
+        auto x = loads_.find(node_id);
+        if(x == loads_.end()){
+            continue;
+        }
+        vector<int> edges;
+        if(is_lowered){
+            edges = g_->get_edges_of_node(node_id);
+        }else{
+            edges.assign(x->second.held_edges.begin(), x->second.held_edges.end());
+        }
+        for(const auto& edge_id:edges){
+            Fix(edge_id);
+        }
+    }
+}
+
+/*
+ * Sets the level width for the current largest load and checks every
+ * share again. With epsilon' = epsilon / (2 + epsilon) and the top level
+ * sets T_0, T_2, T_4, ..., some T_{2i+2} weighs at most (1+epsilon') times
+ * T_{2i} for i < I = log_{1+epsilon'}(W / w_min), and holds every edge
+ * held in T_{2i}, so its density is at least (L - (2i+1) h) / (1+epsilon').
+ * h = epsilon' (scale / 4) / (2I+1) makes that L / (1+epsilon) for loads
+ * down to a quarter of the scale; the width used is epsilon' (scale / 4)
+ * / resolution_, with resolution_ at most 2I+1.
+ */
+template<class W>
+void DynamicDensestSubgraph<W>::Rebuild(){
+    ++number_of_rebuilds_;
+    for(auto& x:loads_){
+        x.second.held_weight = 0;
+    }
+    for(const auto& x:shares_){
+        for(const auto& share:x.second){
+            loads_.find(share.first)->second.held_weight += share.second;
+        }
+    }
+    Density<W> weight_of_nodes = 0, min_weight = 0;
+    scale_ = 0;
+    for(const auto& x:loads_){
+        if(x.second.weight > 0){
+            weight_of_nodes += x.second.weight;
+            min_weight = min_weight == 0 ? x.second.weight : std::min(min_weight, x.second.weight);
+            scale_ = std::max(scale_, x.second.get_load());
+        }
+    }
+    double epsilon = epsilon_ / (2 + epsilon_);
+    double number_of_steps = min_weight > 0 ? std::ceil(std::log((double)weight_of_nodes / (double)min_weight + 1) / std::log(1 + epsilon)) : 1;
+    max_resolution_ = 2 * (int)std::min(std::max(number_of_steps, 1.0), 1e8) + 1;
+    resolution_ = std::min(resolution_, max_resolution_);
+    width_ = epsilon * (scale_ / 4) / resolution_;
+    buckets_.clear();
+    queue_.clear();
+    is_queued_.clear();
+    is_lowered_.clear();
+    for(auto& x:loads_){
+        x.second.level = width_ > 0 ? (long long)std::floor(x.second.get_load() / width_) : 0;
+        buckets_[x.second.level].insert(x.first);
+    }
+    if(width_ > 0){
+        for(const auto& x:loads_){
+            if(!x.second.held_edges.empty()){
+                is_queued_.insert(x.first);
+                queue_.push_back(x.first);
+            }
+        }
+        Balance();
+    }
+}
+
+/*
+ * Rebuilds the levels once the largest load leaves [scale / 4, 4 scale].
+ */
+template<class W>
+void DynamicDensestSubgraph<W>::CheckScale(){
+    if(buckets_.empty()){
+        return;
+    }
+    if(width_ == 0){
+        if(!shares_.empty()){
+            Rebuild();
+        }
+        return;
+    }
+    long long top = buckets_.rbegin()->first;
+    if(top * width_ > 4 * scale_ || (top + 1) * width_ < scale_ / 4){
+        Rebuild();
+    }
+}
+
+/*
+ * The densest of the top level sets whose levels reach max_load /
+ * (1+epsilon), found by adding the levels from the top and counting the
+ * pins of every edge inside. Pins of weight 0 cost nothing, so they are
+ * counted as inside and join the set with the edges they complete.
+ */
+template<class W>
+vector<int> DynamicDensestSubgraph<W>::GetTopLevelSet(const Density<W> max_load) const{
+    vector<int> ans;
+    vector<std::pair<int, int> > completed_edges;
+    HashMap<int, int> number_of_pins_outside;
+    Weight<W> weight_of_nodes = 0, weight_of_edges = 0;
+    Density<W> best_density = -1;
+    int best_size = 0;
+    for(auto x = buckets_.rbegin(); x != buckets_.rend(); ++x){
+        if(width_ > 0 && (x->first + 1) * width_ < max_load / (1 + epsilon_)){
+            break;
+        }
+        for(const auto& node_id:x->second){
+            if(loads_.find(node_id)->second.weight == 0){
+                continue;
+            }
+            ans.push_back(node_id);
+            weight_of_nodes += g_->get_weight_of_node(node_id);
+            for(const auto& edge_id:g_->get_edges_of_node(node_id)){
+                auto y = number_of_pins_outside.find(edge_id);
+                if(y == number_of_pins_outside.end()){
+                    int number_of_pins = 0;
+                    for(const auto& pin:g_->get_nodes_of_edge(edge_id)){
+                        number_of_pins += loads_.find(pin)->second.weight > 0;
+                    }
+                    y = number_of_pins_outside.insert(std::make_pair(edge_id, number_of_pins)).first;
+                }
+                if(--y->second == 0){
+                    weight_of_edges += g_->get_weight_of_edge(edge_id);
+                    completed_edges.push_back(std::make_pair(edge_id, (int)ans.size()));
+                }
+            }
+        }
+        Density<W> density = cmp(weight_of_nodes, 0) > 0 ? (Density<W>)weight_of_edges / weight_of_nodes : 0;
+        if(density > best_density){
+            best_density = density;
+            best_size = ans.size();
+        }
+    }
+    ans.resize(best_size);
+    for(const auto& x:completed_edges){
+        if(x.second > best_size){
+            continue;
+        }
+        for(const auto& pin:g_->get_nodes_of_edge(x.first)){
+            if(loads_.find(pin)->second.weight == 0){
+                ans.push_back(pin);
+            }
+        }
+    }
+    return ans;
+}
+
+template<class W>
+void DynamicDensestSubgraph<W>::Track(const Hypergraph<W>* s){
+    TrackedSubgraph<W> t;
+    t.nodes = s->get_node_set();
+    t.weight_of_nodes = s->get_weight_of_nodes();
+    t.weight_of_edges = s->get_weight_of_edges();
+    subgraphs_.push_back(t);
+}
+
+/*
+ * Replaces the first subgraph by the densest top level set, halving the
+ * level width while that set does not certify the ratio and the width
+ * is above the one that guarantees it; while an edge has only pins of
+ * weight 0, the greedy subgraph and its bound are taken instead. The
+ * exact densest subgraph is solved for only if that fails, and the rest
+ * of the list is built around the first subgraph.
+ */
+template<class W>
+void DynamicDensestSubgraph<W>::Recompute(){
+    #ifdef DEBUG
+    LOG("");
+    #endif
+
+    if(g_->get_number_of_erasures() > g_->get_number_of_nodes() + g_->get_number_of_edges()){
+        DynamicHypergraph<W>* compacted = new DynamicHypergraph<W>(*g_);
+        delete g_;
+        g_ = compacted;
+    }
+    ++number_of_recomputes_;
+    subgraphs_.clear();
+    Hypergraph<W>* s = nullptr;
+    if(!unbounded_edges_.empty()){
+        s = GreedyAlgorithm((const Hypergraph<W>*)g_, upper_bound_);
+    }
+    while(s == nullptr){
+        s = GenerateInducedSubgraph((const Hypergraph<W>*)g_, GetTopLevelSet(upper_bound_));
+        if(cmp(upper_bound_, (1 + epsilon_) * s->get_density()) <= 0 || resolution_ >= max_resolution_){
+            break;
+        }
+        delete s;
+        resolution_ = std::min(2 * resolution_, max_resolution_);
+        s = nullptr;
+        Rebuild();
+        upper_bound_ = get_max_load();
+    }
+    if(cmp(upper_bound_, (1 + epsilon_) * s->get_density()) > 0){
+        delete s;
+        s = UniquenessAlgorithm::FindDensestSubgraph((const Hypergraph<W>*)g_);
+        upper_bound_ = s->get_density();
+        ++number_of_exact_recomputes_;
+    }
+    Track(s);
+    Hypergraph<W>* h = new Hypergraph<W>(*g_);
+    NodesRemovalForLimitedOverlap(s, h, alpha_, way_to_remove_nodes_);
+    delete s;
+    while((int)subgraphs_.size() < k_ && !h->is_empty()){
+        Hypergraph<W>* g_i = GreedyAlgorithm(h);
+        Track(g_i);
+        NodesRemovalForLimitedOverlap(g_i, h, alpha_, way_to_remove_nodes_);
+        delete g_i;
+    }
+    delete h;
+}
+
+/*
+ * The largest load is the upper bound; the list is kept while its first
+ * subgraph is within 1+epsilon of it.
+ */
+template<class W>
+void DynamicDensestSubgraph<W>::Refresh(){
+    upper_bound_ = unbounded_edges_.empty() ? get_max_load() : (Density<W>)kInf;
+    if(subgraphs_.empty() || cmp(upper_bound_, (1 + epsilon_) * get_density()) > 0){
+        Recompute();
+    }
+}
+
+template<class W>
+bool DynamicDensestSubgraph<W>::InsertNode(const int node_id, const Weight<W> node_weight){
+    if(!g_->InsertNode(node_id, node_weight)){
+        return false;
+    }
+    AddLoad(node_id);
+    ++number_of_updates_;
+    return true;
+}
+
+template<class W>
+int DynamicDensestSubgraph<W>::InsertEdge(const vector<int>& nodes, const Weight<W> edge_weight){
+    int edge_id = g_->InsertEdge(nodes, edge_weight);
+    if(edge_id < 0){
+        return -1;
+    }
+    ++number_of_updates_;
+    vector<int> pins = g_->get_nodes_of_edge(edge_id);
+    Weight<W> weight = g_->get_weight_of_edge(edge_id);
+    for(auto& t:subgraphs_){
+        if(IsInside(t.nodes, pins)){
+            t.weight_of_edges += weight;
+        }
+    }
+    Assign(edge_id);
+    Balance();
+    CheckScale();
+    return edge_id;
+}
+
+template<class W>
+bool DynamicDensestSubgraph<W>::DeleteNode(const int node_id){
+    if(!g_->has_node(node_id)){
+        return false;
+    }
+    vector<int> edges = g_->get_edges_of_node(node_id);
+    for(auto& t:subgraphs_){
+        if(t.nodes.find(node_id) == t.nodes.end()){
+            continue;
+        }
+        for(const auto& edge_id:edges){
+            if(IsInside(t.nodes, g_->get_nodes_of_edge(edge_id))){
+                t.weight_of_edges -= g_->get_weight_of_edge(edge_id);
+            }
+        }
+        t.nodes.erase(node_id);
+        t.weight_of_nodes -= g_->get_weight_of_node(node_id);
+    }
+    for(const auto& edge_id:edges){
+        Unassign(edge_id);
+    }
+    g_->DeleteNode(node_id);
+    auto bucket = buckets_.find(loads_[node_id].level);
+    bucket->second.erase(node_id);
+    if(bucket->second.empty()){
+        buckets_.erase(bucket);
+    }
+    loads_.erase(node_id);
+    ++number_of_updates_;
+    Balance();
+    CheckScale();
+    return true;
+}
+
+template<class W>
+bool DynamicDensestSubgraph<W>::DeleteEdge(const int edge_id){
+    if(!g_->has_edge(edge_id)){
+        return false;
+    }
+    vector<int> pins = g_->get_nodes_of_edge(edge_id);
+    for(auto& t:subgraphs_){
+        if(IsInside(t.nodes, pins)){
+            t.weight_of_edges -= g_->get_weight_of_edge(edge_id);
+        }
+    }
+    Unassign(edge_id);
+    g_->DeleteEdge(edge_id);
+    ++number_of_updates_;
+    Balance();
+    CheckScale();
+    return true;
+}
+
+template<class W>
+const DynamicHypergraph<W>* DynamicDensestSubgraph<W>::get_graph() const{
+    return g_;
+}
+
+template<class W>
+Density<W> DynamicDensestSubgraph<W>::get_density() const{
+    return subgraphs_[0].get_density();
+}
+
+template<class W>
+Density<W> DynamicDensestSubgraph<W>::get_upper_bound() const{
+    return upper_bound_;
+}
+
+template<class W>
+int DynamicDensestSubgraph<W>::get_number_of_updates() const{
+    return number_of_updates_;
+}
+
+template<class W>
+int DynamicDensestSubgraph<W>::get_number_of_recomputes() const{
+    return number_of_recomputes_;
+}
+
+template<class W>
+int DynamicDensestSubgraph<W>::get_number_of_exact_recomputes() const{
+    return number_of_exact_recomputes_;
+}
+
+template<class W>
+int DynamicDensestSubgraph<W>::get_number_of_rebuilds() const{
+    return number_of_rebuilds_;
+}
+
+template<class W>
+long long DynamicDensestSubgraph<W>::get_number_of_moves() const{
+    return number_of_moves_;
+}
+
+/*
+ * Materializes the tracked node sets as subgraphs induced in the current graph.
+ */
+template<class W>
+vector<Hypergraph<W>*> DynamicDensestSubgraph<W>::get_subgraphs() const{
+    vector<Hypergraph<W>*> ans;
+    for(const auto& t:subgraphs_){
+        ans.push_back(GenerateInducedSubgraph((const Hypergraph<W>*)g_, vector<int>(t.nodes.begin(), t.nodes.end())));
+    }
+    return ans;
+}
+
+#define INSTANTIATE_DYNAMIC(W) \
+template struct TrackedSubgraph<W>; \
+template struct NodeLoad<W>; \
+template class DynamicDensestSubgraph<W>;
+
+FOR_EACH_WEIGHT_TYPE(INSTANTIATE_DYNAMIC)
@@ -0,0 +1,139 @@
+/*
+ *
+ * For paper 'Finding Subgraphs with Maximum Total Density and Limited Overlap in Weighted Hypergraphs'
+ *
+ * Copyright reserved.
+ *
+ */
+
+#ifndef __DYNAMIC__
+#define __DYNAMIC__
+
+#include "hypergraph.h"
+
+#include <deque>
+#include <map>
+
+/**********TrackedSubgraph**********/
+
+/*
+ * A node set whose induced weights are kept exact under updates, so its
+ * density is known without looking at the rest of the graph.
+ */
+template<class W>
+struct TrackedSubgraph{
+set nodes;
+Weight<W> weight_of_nodes = 0;
+Weight<W> weight_of_edges = 0;
+Density<W> get_density() const;
+};
+
+/**********NodeLoad**********/
+
+/*
+ * The edge weight a node holds and the edges it holds a share of. A node
+ * of weight 0 holds nothing.
+ */
+template<class W>
+struct NodeLoad{
+Density<W> weight = 0;
+Density<W> held_weight = 0;
+long long level = 0;
+set held_edges;
+Density<W> get_load() const;
+};
+
+/**********DynamicDensestSubgraph**********/
+
+/*
+ * A (1+epsilon)-approximate densest subgraph of a dynamic hypergraph, and
+ * the limited-overlap list of k subgraphs built around it.
+ *
+ * Every edge splits its weight among its pins, and the load of a node is
+ * the weight it holds over its own weight, so the largest load bounds the
+ * optimum from above whatever the split. Loads are cut into levels of
+ * width h, and the split is kept balanced: a pin holding a share of an
+ * edge is at most two levels above any other pin of it. Then the edges
+ * held in a top level set lie in the set two levels further down, and h
+ * is small enough that one of these sets is within 1+epsilon of the
+ * largest load. An update hands the weight of one edge to its least
+ * loaded pin or frees it, and shares are moved down until the levels are
+ * balanced again. A move lowers the sum of w(v) load(v)^2 by at least
+ * 3.5 h per unit of weight moved, so the weight moved is amortized
+ * O(L / h) per unit of weight inserted, at most O(log(W / w_min) /
+ * epsilon^2), and a node is rescanned only when its level changes. h
+ * follows the largest load, and the levels are rebuilt in one pass when
+ * that load leaves [scale / 4, 4 scale]. h starts coarse and is halved
+ * only when no top level set certifies the ratio, down to the width that
+ * guarantees one does.
+ *
+ * Refresh keeps the list while the tracked density of its first subgraph
+ * is within 1+epsilon of the largest load, and otherwise takes the
+ * densest top level set, solving the exact LP only if that set does not
+ * certify the ratio. Only the first subgraph is certified: the others are
+ * greedy subgraphs of what is left around it, recomputed whenever the
+ * first one is replaced.
+ */
+template<class W>
+class DynamicDensestSubgraph{
+private:
+DynamicHypergraph<W>* g_;
+double epsilon_;
+int k_;
+double alpha_;
+int way_to_remove_nodes_;
+vector<TrackedSubgraph<W> > subgraphs_;
+HashMap<int, vector<std::pair<int, Density<W> > > > shares_;
+HashMap<int, NodeLoad<W> > loads_;
+std::map<long long, set> buckets_;
+std::deque<int> queue_;
+set is_queued_;
+Density<W> scale_;
+Density<W> width_;
+int resolution_;
+int max_resolution_;
+set unbounded_edges_;
+set is_lowered_;
+Density<W> upper_bound_;
+int number_of_updates_;
+int number_of_recomputes_;
+int number_of_exact_recomputes_;
+int number_of_rebuilds_;
+long long number_of_moves_;
+Density<W> get_max_load() const;
+void AddLoad(const int);
+void Relevel(const int, NodeLoad<W>&);
+void Assign(const int);
+void Unassign(const int);
+void Move(const int, const int, const int);
+void Fix(const int);
+void Balance();
+void Rebuild();
+void CheckScale();
+vector<int> GetTopLevelSet(const Density<W>) const;
+void Track(const Hypergraph<W>*);
+void Recompute();
+
+public:
+DynamicDensestSubgraph(DynamicHypergraph<W>*, const double, const int, const double, const int);
+~DynamicDensestSubgraph();
+bool InsertNode(const int, const Weight<W>);
+int InsertEdge(const vector<int>&, const Weight<W>);
+bool DeleteNode(const int);
+bool DeleteEdge(const int);
+void Refresh();
+const DynamicHypergraph<W>* get_graph() const;
+Density<W> get_density() const;
+Density<W> get_upper_bound() const;
+int get_number_of_updates() const;
+int get_number_of_recomputes() const;
+int get_number_of_exact_recomputes() const;
+int get_number_of_rebuilds() const;
+long long get_number_of_moves() const;
+vector<Hypergraph<W>*> get_subgraphs() const;
+
+};
+
+// #include "dynamic.cc"
+
+#endif // __DYNAMIC__
@@ -0,0 +1,406 @@
+/*
+ *
+ * For paper 'Finding Subgraphs with Maximum Total Density and Limited Overlap in Weighted Hypergraphs'
+ *
+ * Copyright reserved.
+ *
+ */
+
+#include "external.h"
+#include "algorithms.h"
+#include "macro.h"
+#include "utility.h"
+
+#include <algorithm>
+#include <type_traits>
+#include <cstdlib>
+#include <limits>
+#include <unistd.h>
+
+/**********SemiExternalHypergraph**********/
+
+/*
+ * Nodes are kept sorted by id, so that the dense index of a node is its
+ * rank and no id map outlives the conversion. The spill file is unlinked
+ * as soon as it is opened and vanishes with the process.
+ */
+template<class W>
+SemiExternalHypergraph<W>::SemiExternalHypergraph(const string node_file, const string edge_file, const string spill_directory, const bool is_compressed): number_of_edges_(0), number_of_pins_(0), is_compressed_(is_compressed), bytes_of_spill_(0), number_of_pins_streamed_(0), seconds_streaming_(0){
+    Input node_input(node_file.c_str());
+    int node_id;
+    Weight<W> node_weight;
+    vector<std::pair<int, Weight<W> > > nodes;
+    while(Node<W>::Read(node_input, node_id, node_weight)){
+        nodes.push_back(std::make_pair(node_id, std::is_same<W, Unweighted>::value ? 1 : node_weight));
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const std::pair<int, Weight<W> >& x, const std::pair<int, Weight<W> >& y){return x.first < y.first;});
+    for(const auto& x:nodes){
+        if(!node_ids_.empty() && node_ids_.back() == x.first){
+            node_weights_.back() = x.second;
+            continue;
+        }
+        node_ids_.push_back(x.first);
+        node_weights_.push_back(x.second);
+    }
+    vector<std::pair<int, Weight<W> > >().swap(nodes);
+    number_of_alive_nodes_ = node_ids_.size();
+    is_alive_.assign(number_of_alive_nodes_, true);
+    charge_ = new MemoryCharge("graph", (long long)node_ids_.size() * (sizeof(int) + sizeof(Weight<W>)));
+
+    string path = spill_directory + "/dslo_edges_XXXXXX";
+    int descriptor = mkstemp(&path[0]);
+    if(descriptor < 0 || (spill_ = fdopen(descriptor, "w+b")) == nullptr){
+        Console::Error("Can't create a spill file in <" + spill_directory + ">!");
+    }
+    unlink(path.c_str());
+    std::setvbuf(spill_, nullptr, _IOFBF, 1 << 20);
+
+    Input edge_input(edge_file.c_str());
+    Weight<W> edge_weight;
+    vector<int> pins;
+    while(Edge<W>::Read(edge_input, edge_weight, pins)){
+        for(auto& x:pins){
+            auto it = std::lower_bound(node_ids_.begin(), node_ids_.end(), x);
+            if(it == node_ids_.end() || *it != x){
+                Console::Error("Undefined Node.");
+            }
+            x = it - node_ids_.begin();
+        }
+        std::sort(pins.begin(), pins.end());
+        pins.erase(std::unique(pins.begin(), pins.end()), pins.end());
+        if(std::is_same<W, Unweighted>::value){
+            edge_weight = 1;
+        }
+        int size = pins.size();
+        const void* data = pins.data();
+        size_t bytes_of_data = size * sizeof(int);
+        if(is_compressed_){
+            buffer_.clear();
+            CompressedPinLists::Encode(pins, buffer_);
+            size = buffer_.size();
+            data = buffer_.data();
+            bytes_of_data = size;
+        }
+        if(std::fwrite(&size, sizeof(int), 1, spill_) != 1 || std::fwrite(&edge_weight, sizeof(Weight<W>), 1, spill_) != 1 || std::fwrite(data, 1, bytes_of_data, spill_) != bytes_of_data){
+            Console::Error("Can't write the spill file in <" + spill_directory + ">!");
+        }
+        ++number_of_edges_;
+        number_of_pins_ += pins.size();
+        bytes_of_spill_ += sizeof(int) + sizeof(Weight<W>) + bytes_of_data;
+    }
+    std::fflush(spill_);
+}
+
+template<class W>
+SemiExternalHypergraph<W>::~SemiExternalHypergraph(){
+    std::fclose(spill_);
+    delete charge_;
+}
+
+template<class W>
+void SemiExternalHypergraph<W>::Rewind(){
+    std::rewind(spill_);
+    pass_start_ = std::chrono::steady_clock::now();
+}
+
+/*
+ * A record is the size of its payload, the edge weight and the payload:
+ * the pins as ints, or their encoding when the spill is compressed. The
+ * time from Rewind to the end of the file counts as streaming time.
+ */
+template<class W>
+bool SemiExternalHypergraph<W>::NextEdge(Weight<W>& weight, vector<int>& pins){
+    int size;
+    if(std::fread(&size, sizeof(int), 1, spill_) != 1){
+        seconds_streaming_ += std::chrono::duration<double>(std::chrono::steady_clock::now() - pass_start_).count();
+        return false;
+    }
+    bool is_read = std::fread(&weight, sizeof(Weight<W>), 1, spill_) == 1;
+    if(is_compressed_){
+        buffer_.resize(size);
+        is_read = is_read && std::fread(buffer_.data(), 1, size, spill_) == (size_t)size;
+        if(is_read){
+            CompressedPinLists::Iterator it(buffer_.data());
+            pins.resize(it.get_size());
+            for(auto& x:pins){
+                x = *it;
+                ++it;
+            }
+        }
+    }else{
+        pins.resize(size);
+        is_read = is_read && std::fread(pins.data(), sizeof(int), size, spill_) == (size_t)size;
+    }
+    if(!is_read){
+        Console::Error("The spill file is truncated!");
+    }
+    number_of_pins_streamed_ += pins.size();
+    return true;
+}
+
+template<class W>
+int SemiExternalHypergraph<W>::get_number_of_nodes() const{
+    return number_of_alive_nodes_;
+}
+
+template<class W>
+long long SemiExternalHypergraph<W>::get_number_of_edges() const{
+    return number_of_edges_;
+}
+
+template<class W>
+long long SemiExternalHypergraph<W>::get_number_of_pins() const{
+    return number_of_pins_;
+}
+
+template<class W>
+long long SemiExternalHypergraph<W>::get_bytes_of_spill() const{
+    return bytes_of_spill_;
+}
+
+template<class W>
+long long SemiExternalHypergraph<W>::get_bytes_of_raw_spill() const{
+    return number_of_edges_ * (long long)(sizeof(int) + sizeof(Weight<W>)) + number_of_pins_ * (long long)sizeof(int);
+}
+
+template<class W>
+double SemiExternalHypergraph<W>::get_pins_per_second() const{
+    return seconds_streaming_ > 0 ? number_of_pins_streamed_ / seconds_streaming_ : 0;
+}
+
+template<class W>
+bool SemiExternalHypergraph<W>::is_empty() const{
+    return number_of_alive_nodes_ == 0;
+}
+
+/*
+ * Batch peeling with one pass over the spill file per round: every alive
+ * node whose degree is at most (1+epsilon) times the average degree per
+ * unit of node weight leaves at once. Since the node of minimum degree
+ * always leaves, the rounds end, and the densest set seen is within a factor
+ * of (1+epsilon) times the largest edge size of the optimum. Returns the
+ * dense indices of that set.
+ */
+template<class W>
+vector<int> SemiExternalHypergraph<W>::Peel(const double epsilon, Density<W>& density, int& number_of_passes){
+    MemoryPhase phase("peel");
+    int n = node_ids_.size();
+    const int kNever = std::numeric_limits<int>::max();
+    vector<int> round_of_removal(n, -1);
+    vector<Weight<W> > degrees(n);
+    MemoryCharge state_charge("scratch", (long long)n * (sizeof(int) + sizeof(Weight<W>)));
+    Weight<W> weight_of_nodes = 0;
+    int number_of_members = 0;
+    for(int v = 0; v < n; ++v){
+        if(is_alive_[v]){
+            round_of_removal[v] = kNever;
+            weight_of_nodes += node_weights_[v];
+            ++number_of_members;
+        }
+    }
+    density = -1;
+    int best_round = 0;
+    Weight<W> weight;
+    vector<int> pins;
+    for(number_of_passes = 0; number_of_members > 0; ++number_of_passes){
+        int r = number_of_passes;
+        for(int v = 0; v < n; ++v){
+            degrees[v] = 0;
+        }
+        Weight<W> weight_of_edges = 0, weight_of_pins = 0;
+        Rewind();
+        while(NextEdge(weight, pins)){
+            if(pins.empty()){
+                continue;
+            }
+            bool is_inside = true;
+            for(const auto& v:pins){
+                if(round_of_removal[v] < r){
+                    is_inside = false;
+                    break;
+                }
+            }
+            if(!is_inside){
+                continue;
+            }
+            weight_of_edges += weight;
+            weight_of_pins += weight * (Weight<W>)pins.size();
+            for(const auto& v:pins){
+                degrees[v] += weight;
+            }
+        }
+        Density<W> rho = cmp(weight_of_nodes, 0) > 0 ? (Density<W>)weight_of_edges / weight_of_nodes : 0;
+        if(cmp(rho, density) > 0){
+            density = rho;
+            best_round = r;
+        }
+        Density<W> threshold = cmp(weight_of_nodes, 0) > 0 ? (1 + epsilon) * (Density<W>)weight_of_pins / weight_of_nodes : 0;
+        for(int v = 0; v < n; ++v){
+            if(round_of_removal[v] == kNever && cmp((Density<W>)degrees[v], threshold * node_weights_[v]) <= 0){
+                round_of_removal[v] = r;
+                weight_of_nodes -= node_weights_[v];
+                --number_of_members;
+            }
+        }
+    }
+    vector<int> ans;
+    for(int v = 0; v < n; ++v){
+        if(round_of_removal[v] >= best_round){
+            ans.push_back(v);
+        }
+    }
+    return ans;
+}
+
+/*
+ * One pass collecting the edges with every pin among the members, with
+ * the edge ids of the in-memory graph: the rank in the hypergraph file.
+ */
+template<class W>
+Hypergraph<W>* SemiExternalHypergraph<W>::GenerateInducedSubgraph(const vector<int>& members){
+    vector<bool> is_member(node_ids_.size(), false);
+    Hypergraph<W>* ans = new Hypergraph<W>();
+    for(const auto& v:members){
+        is_member[v] = true;
+        ans->AddNode(node_ids_[v], node_weights_[v]);
+    }
+    Weight<W> weight;
+    vector<int> pins;
+    Rewind();
+    for(int edge_id = 0; NextEdge(weight, pins); ++edge_id){
+        bool is_inside = !pins.empty();
+        for(const auto& v:pins){
+            if(!is_member[v]){
+                is_inside = false;
+                break;
+            }
+        }
+        if(!is_inside){
+            continue;
+        }
+        for(auto& v:pins){
+            v = node_ids_[v];
+        }
+        ans->AddEdge(pins, weight, edge_id);
+    }
+    return ans;
+}
+
+/*
+ * The nodes of subgraph with every alive edge touching them, cut down to
+ * the pins inside subgraph. It stands in for the residual graph when
+ * NodesRemovalForLimitedOverlap only looks at the nodes of subgraph.
+ */
+template<class W>
+Hypergraph<W>* SemiExternalHypergraph<W>::GenerateNeighborhood(const Hypergraph<W>* subgraph){
+    vector<bool> is_member(node_ids_.size(), false);
+    Hypergraph<W>* ans = new Hypergraph<W>();
+    for(const auto& node_id:subgraph->get_node_set()){
+        int v = std::lower_bound(node_ids_.begin(), node_ids_.end(), node_id) - node_ids_.begin();
+        is_member[v] = true;
+        ans->AddNode(node_id, node_weights_[v]);
+    }
+    Weight<W> weight;
+    vector<int> pins, nodes;
+    Rewind();
+    for(int edge_id = 0; NextEdge(weight, pins); ++edge_id){
+        bool is_alive = true;
+        nodes.clear();
+        for(const auto& v:pins){
+            if(!is_alive_[v]){
+                is_alive = false;
+                break;
+            }
+            if(is_member[v]){
+                nodes.push_back(node_ids_[v]);
+            }
+        }
+        if(is_alive && !nodes.empty()){
+            ans->AddEdge(nodes, weight, edge_id);
+        }
+    }
+    return ans;
+}
+
+template<class W>
+void SemiExternalHypergraph<W>::RemoveNodeSet(const set node_set){
+    for(const auto& node_id:node_set){
+        auto it = std::lower_bound(node_ids_.begin(), node_ids_.end(), node_id);
+        if(it != node_ids_.end() && *it == node_id && is_alive_[it - node_ids_.begin()]){
+            is_alive_[it - node_ids_.begin()] = false;
+            --number_of_alive_nodes_;
+        }
+    }
+}
+
+/**********SemiExternalAlgorithm**********/
+
+template<class W>
+Hypergraph<W>* SemiExternalAlgorithm::GreedyAlgorithm(SemiExternalHypergraph<W>* g, const double epsilon){
+    #ifdef DEBUG
+    LOG("");
+    #endif
+
+    Density<W> density;
+    int number_of_passes;
+    vector<int> members = g->Peel(epsilon, density, number_of_passes);
+    Console::Log("Peeled " + Int2String(g->get_number_of_nodes()) + " nodes in " + Int2String(number_of_passes) + " passes.");
+    return g->GenerateInducedSubgraph(members);
+}
+
+template<class W>
+vector<Hypergraph<W>*> SemiExternalAlgorithm::NaiveApprox(SemiExternalHypergraph<W>* g, const int k, const double epsilon, Output& output){
+    #ifdef DEBUG
+    LOG("");
+    #endif
+
+    vector<Hypergraph<W>*> l;
+    while(((int)l.size() < k) && !g->is_empty()){
+        Hypergraph<W>* g_i = GreedyAlgorithm(g, epsilon);
+        l.push_back(g_i);
+        Console::Show("[" + Int2String(l.size()) + "]\t" + Int2String(g_i->get_number_of_nodes()) + " nodes, " + Int2String(g_i->get_number_of_edges()) + " edges, density = " + Double2String(g_i->get_density()));
+        Console::Show("");
+        #ifndef TURNOFFGRAPHOUTPUT
+        g_i->Print(output, FEATURE("Density", Double2String(g_i->get_density())));
+        #endif // TURNOFFGRAPHOUTPUT
+        g->RemoveNodeSet(g_i->get_node_set());
+    }
+    return l;
+}
+
+template<class W>
+vector<Hypergraph<W>*> SemiExternalAlgorithm::ApproxMinAndRemove(SemiExternalHypergraph<W>* g, const int k, const double alpha, const int way_to_remove_nodes, const double epsilon, Output& output){
+    #ifdef DEBUG
+    LOG("");
+    #endif
+
+    vector<Hypergraph<W>*> l;
+    while(((int)l.size() < k) && !g->is_empty()){
+        Hypergraph<W>* g_i = GreedyAlgorithm(g, epsilon);
+        l.push_back(g_i);
+        Console::Show("[" + Int2String(l.size()) + "]\t" + Int2String(g_i->get_number_of_nodes()) + " nodes, " + Int2String(g_i->get_number_of_edges()) + " edges, density = " + Double2String(g_i->get_density()));
+        Console::Show("");
+        #ifndef TURNOFFGRAPHOUTPUT
+        g_i->Print(output, FEATURE("Density", Double2String(g_i->get_density())));
+        #endif // TURNOFFGRAPHOUTPUT
+        Hypergraph<W>* h = g->GenerateNeighborhood(g_i);
+        NodesRemovalForLimitedOverlap(g_i, h, alpha, way_to_remove_nodes);
+        set removed_nodes;
+        for(const auto& node_id:g_i->get_node_set()){
+            if(!h->has_node(node_id)){
+                removed_nodes.insert(node_id);
+            }
+        }
+        delete h;
+        g->RemoveNodeSet(removed_nodes);
+    }
+    return l;
+}
+
+#define INSTANTIATE_EXTERNAL(W) \
+template class SemiExternalHypergraph<W>; \
+template Hypergraph<W>* SemiExternalAlgorithm::GreedyAlgorithm(SemiExternalHypergraph<W>*, const double); \
+template vector<Hypergraph<W>*> SemiExternalAlgorithm::NaiveApprox(SemiExternalHypergraph<W>*, const int, const double, Output&); \
+template vector<Hypergraph<W>*> SemiExternalAlgorithm::ApproxMinAndRemove(SemiExternalHypergraph<W>*, const int, const double, const int, const double, Output&);
+
+FOR_EACH_WEIGHT_TYPE(INSTANTIATE_EXTERNAL)
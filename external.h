@@ -0,0 +1,76 @@
+/*
+ *
+ * For paper 'Finding Subgraphs with Maximum Total Density and Limited Overlap in Weighted Hypergraphs'
+ *
+ * Copyright reserved.
+ *
+ */
+
+#ifndef __EXTERNAL__
+#define __EXTERNAL__
+
+#include "hypergraph.h"
+
+#include <cstdio>
+#include <chrono>
+
+/**********SemiExternalHypergraph**********/
+
+/*
+ * A hypergraph whose edges stay on disk. Only per-node state lives in
+ * memory (id, weight, degree and alive flag); the edge file is converted
+ * once into a binary spill file of dense pin indices, which every pass
+ * streams sequentially. An edge is alive while all of its pins are alive,
+ * as in the residual graphs of the in-memory algorithms. With compression
+ * the pins of an edge are spilled as one CompressedPinLists list.
+ */
+template<class W>
+class SemiExternalHypergraph{
+
+private:
+vector<int> node_ids_;
+vector<Weight<W> > node_weights_;
+vector<bool> is_alive_;
+int number_of_alive_nodes_;
+long long number_of_edges_;
+long long number_of_pins_;
+bool is_compressed_;
+long long bytes_of_spill_;
+vector<uint8_t> buffer_;
+long long number_of_pins_streamed_;
+double seconds_streaming_;
+std::chrono::steady_clock::time_point pass_start_;
+std::FILE* spill_;
+MemoryCharge* charge_;
+void Rewind();
+bool NextEdge(Weight<W>&, vector<int>&);
+
+public:
+SemiExternalHypergraph(const string, const string, const string, const bool is_compressed=false);
+~SemiExternalHypergraph();
+int get_number_of_nodes() const;
+long long get_number_of_edges() const;
+long long get_number_of_pins() const;
+long long get_bytes_of_spill() const;
+long long get_bytes_of_raw_spill() const;
+double get_pins_per_second() const;
+bool is_empty() const;
+vector<int> Peel(const double, Density<W>&, int&);
+Hypergraph<W>* GenerateInducedSubgraph(const vector<int>&);
+Hypergraph<W>* GenerateNeighborhood(const Hypergraph<W>*);
+void RemoveNodeSet(const set);
+
+};
+
+namespace SemiExternalAlgorithm{
+    template<class W>
+    Hypergraph<W>* GreedyAlgorithm(SemiExternalHypergraph<W>*, const double);
+    template<class W>
+    vector<Hypergraph<W>*> NaiveApprox(SemiExternalHypergraph<W>*, const int, const double, Output&);
+    template<class W>
+    vector<Hypergraph<W>*> ApproxMinAndRemove(SemiExternalHypergraph<W>*, const int, const double, const int way_to_remove_nodes, const double, Output&);
+}
+
+// #include "external.cc"
+
+#endif // __EXTERNAL__
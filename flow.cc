@@ -0,0 +1,557 @@
+/*
+ *
+ * For paper 'Finding Subgraphs with Maximum Total Density and Limited Overlap in Weighted Hypergraphs'
+ *
+ * Copyright reserved.
+ *
+ */
+
+#include "flow.h"
+#include "algorithms.h"
+#include "macro.h"
+#include "utility.h"
+#include <algorithm>
+
+/**********MaxFlow**********/
+
+template<class T>
+MaxFlow<T>::MaxFlow(const int number_of_vertices): adjacency_(number_of_vertices), level_(number_of_vertices), next_(number_of_vertices){}
+
+template<class T>
+int MaxFlow<T>::get_number_of_vertices() const{
+    return adjacency_.size();
+}
+
+template<class T>
+long long MaxFlow<T>::get_bytes() const{
+    long long ans = arcs_.capacity() * sizeof(Arc) + adjacency_.size() * (sizeof(vector<int>) + 2 * sizeof(int));
+    for(const auto& x:adjacency_){
+        ans += x.capacity() * sizeof(int);
+    }
+    return ans;
+}
+
+template<class T>
+void MaxFlow<T>::AddArc(const int from, const int to, const T capacity){
+    adjacency_[from].push_back(arcs_.size());
+    arcs_.push_back(Arc{to, capacity});
+    adjacency_[to].push_back(arcs_.size());
+    arcs_.push_back(Arc{from, 0});
+}
+
+template<class T>
+bool MaxFlow<T>::BuildLevels(const int source, const int sink){
+    std::fill(level_.begin(), level_.end(), -1);
+    vector<int> queue(1, source);
+    level_[source] = 0;
+    for(int head = 0; head < (int)queue.size(); ++head){
+        int u = queue[head];
+        for(const auto& a:adjacency_[u]){
+            const Arc& arc = arcs_[a];
+            if(level_[arc.to] < 0 && cmp(arc.residual, 0) > 0){
+                level_[arc.to] = level_[u] + 1;
+                queue.push_back(arc.to);
+            }
+        }
+    }
+    return level_[sink] >= 0;
+}
+
+/*
+ * Blocking flow of one phase, found by an explicit path stack so that long
+ * level graphs do not exhaust the call stack. Dead ends leave the level graph.
+ */
+template<class T>
+T MaxFlow<T>::Augment(const int source, const int sink){
+    T total = 0;
+    vector<int> path;
+    int u = source;
+    while(true){
+        if(u == sink){
+            T flow = arcs_[path[0]].residual;
+            for(const auto& a:path){
+                flow = std::min(flow, arcs_[a].residual);
+            }
+            for(const auto& a:path){
+                arcs_[a].residual -= flow;
+                arcs_[a ^ 1].residual += flow;
+            }
+            total += flow;
+            path.clear();
+            u = source;
+            continue;
+        }
+        bool is_advanced = false;
+        for(int& i = next_[u]; i < (int)adjacency_[u].size(); ++i){
+            const Arc& arc = arcs_[adjacency_[u][i]];
+            if(level_[arc.to] == level_[u] + 1 && cmp(arc.residual, 0) > 0){
+                path.push_back(adjacency_[u][i]);
+                u = arc.to;
+                is_advanced = true;
+                break;
+            }
+        }
+        if(is_advanced){
+            continue;
+        }
+        if(u == source){
+            break;
+        }
+        level_[u] = -1;
+        u = arcs_[path.back() ^ 1].to;
+        path.pop_back();
+        ++next_[u];
+    }
+    return total;
+}
+
+template<class T>
+T MaxFlow<T>::Run(const int source, const int sink){
+    T total = 0;
+    while(BuildLevels(source, sink)){
+        std::fill(next_.begin(), next_.end(), 0);
+        total += Augment(source, sink);
+    }
+    return total;
+}
+
+template<class T>
+vector<bool> MaxFlow<T>::get_reachable_from(const int source) const{
+    vector<bool> ans(adjacency_.size(), false);
+    vector<int> queue(1, source);
+    ans[source] = true;
+    for(int head = 0; head < (int)queue.size(); ++head){
+        for(const auto& a:adjacency_[queue[head]]){
+            const Arc& arc = arcs_[a];
+            if(!ans[arc.to] && cmp(arc.residual, 0) > 0){
+                ans[arc.to] = true;
+                queue.push_back(arc.to);
+            }
+        }
+    }
+    return ans;
+}
+
+template<class T>
+vector<bool> MaxFlow<T>::get_reaching(const int sink) const{
+    vector<bool> ans(adjacency_.size(), false);
+    vector<int> queue(1, sink);
+    ans[sink] = true;
+    for(int head = 0; head < (int)queue.size(); ++head){
+        for(const auto& a:adjacency_[queue[head]]){
+            int v = arcs_[a].to;
+            if(!ans[v] && cmp(arcs_[a ^ 1].residual, 0) > 0){
+                ans[v] = true;
+                queue.push_back(v);
+            }
+        }
+    }
+    return ans;
+}
+
+/*
+ * Strongly connected components of the residual graph induced by the
+ * members, by an iterative Tarjan. Non-members get component -1.
+ */
+template<class T>
+vector<int> MaxFlow<T>::get_components(const vector<bool>& is_member, int& number_of_components) const{
+    int n = adjacency_.size();
+    vector<int> component(n, -1), index(n, -1), low(n, 0);
+    vector<bool> is_on_stack(n, false);
+    vector<int> stack;
+    vector<std::pair<int, int> > calls;
+    int counter = 0;
+    number_of_components = 0;
+    for(int root = 0; root < n; ++root){
+        if(!is_member[root] || index[root] >= 0){
+            continue;
+        }
+        index[root] = low[root] = counter++;
+        stack.push_back(root);
+        is_on_stack[root] = true;
+        calls.push_back(std::make_pair(root, 0));
+        while(!calls.empty()){
+            int u = calls.back().first;
+            if(calls.back().second < (int)adjacency_[u].size()){
+                const Arc& arc = arcs_[adjacency_[u][calls.back().second++]];
+                int v = arc.to;
+                if(!is_member[v] || cmp(arc.residual, 0) <= 0){
+                    continue;
+                }
+                if(index[v] < 0){
+                    index[v] = low[v] = counter++;
+                    stack.push_back(v);
+                    is_on_stack[v] = true;
+                    calls.push_back(std::make_pair(v, 0));
+                }else if(is_on_stack[v]){
+                    low[u] = std::min(low[u], index[v]);
+                }
+                continue;
+            }
+            calls.pop_back();
+            if(!calls.empty()){
+                int parent = calls.back().first;
+                low[parent] = std::min(low[parent], low[u]);
+            }
+            if(low[u] == index[u]){
+                int v;
+                do{
+                    v = stack.back();
+                    stack.pop_back();
+                    is_on_stack[v] = false;
+                    component[v] = number_of_components;
+                }while(v != u);
+                ++number_of_components;
+            }
+        }
+    }
+    return component;
+}
+
+/*
+ * Components with no residual arc to another member component.
+ */
+template<class T>
+vector<bool> MaxFlow<T>::get_sink_components(const vector<bool>& is_member, const vector<int>& component, const int number_of_components) const{
+    vector<bool> ans(number_of_components, true);
+    for(int u = 0; u < (int)adjacency_.size(); ++u){
+        if(!is_member[u]){
+            continue;
+        }
+        for(const auto& a:adjacency_[u]){
+            const Arc& arc = arcs_[a];
+            if(is_member[arc.to] && component[arc.to] != component[u] && cmp(arc.residual, 0) > 0){
+                ans[component[u]] = false;
+            }
+        }
+    }
+    return ans;
+}
+
+/**********ClosureNetwork**********/
+
+/*
+ * The pins are kept delta and varint coded between the cuts, since every
+ * cut rebuilds the network from them. A compressed incidence of g is read
+ * in place of its hash sets.
+ */
+template<class W>
+ClosureNetwork<W>::ClosureNetwork(const Hypergraph<W>* g): network_(nullptr), charge_(nullptr), cut_density_(0), density_(0), number_of_cuts_(0){
+    const CompressedIncidence<W>* incidence = g->get_incidence();
+    if(incidence != nullptr){
+        for(int i = 0; i < incidence->get_number_of_nodes(); ++i){
+            if(g->has_node(incidence->get_node_id(i))){
+                node_ids_.push_back(incidence->get_node_id(i));
+                node_weights_.push_back(incidence->get_weight_of_node(i));
+            }
+        }
+        vector<int> pins;
+        for(int j = 0; j < incidence->get_number_of_edges(); ++j){
+            if(!g->has_edge(incidence->get_edge_id(j))){
+                continue;
+            }
+            pins.clear();
+            for(const auto& i:incidence->get_pins(j)){
+                pins.push_back(incidence->get_node_id(i));
+            }
+            pins_.Append(pins);
+            edge_weights_.push_back(incidence->get_weight_of_edge(j));
+        }
+        pins_.ShrinkToFit();
+    }else{
+        vector<Weight<W> > weights_of_edges;
+        g->GetNodeWeights(node_ids_, node_weights_, weights_of_edges);
+        g->GetEdges(pins_, edge_weights_);
+    }
+    for(int i = 0; i < (int)node_ids_.size(); ++i){
+        index_[node_ids_[i]] = i;
+    }
+}
+
+template<class W>
+ClosureNetwork<W>::~ClosureNetwork(){
+    delete charge_;
+    delete network_;
+}
+
+template<class W>
+int ClosureNetwork<W>::get_number_of_nodes() const{
+    return node_ids_.size();
+}
+
+template<class W>
+int ClosureNetwork<W>::get_number_of_cuts() const{
+    return number_of_cuts_;
+}
+
+template<class W>
+long long ClosureNetwork<W>::get_bytes() const{
+    return pins_.get_bytes() + (long long)node_ids_.size() * (sizeof(int) + sizeof(Weight<W>) + 2 * sizeof(int)) + (long long)edge_weights_.size() * sizeof(Weight<W>);
+}
+
+template<class W>
+const vector<int>& ClosureNetwork<W>::get_node_ids() const{
+    return node_ids_;
+}
+
+template<class W>
+Weight<W> ClosureNetwork<W>::get_weight_of_nodes(const vector<int>& node_ids) const{
+    Weight<W> ans = 0;
+    for(const auto& node_id:node_ids){
+        auto it = index_.find(node_id);
+        if(it != index_.end()){
+            ans += node_weights_[it->second];
+        }
+    }
+    return ans;
+}
+
+template<class W>
+Density<W> ClosureNetwork<W>::get_density(const vector<int>& node_ids) const{
+    vector<bool> is_member(node_ids_.size(), false);
+    Weight<W> weight_of_nodes = 0, weight_of_edges = 0;
+    for(const auto& node_id:node_ids){
+        auto it = index_.find(node_id);
+        if(it != index_.end() && !is_member[it->second]){
+            is_member[it->second] = true;
+            weight_of_nodes += node_weights_[it->second];
+        }
+    }
+    for(int j = 0; j < pins_.get_number_of_lists(); ++j){
+        bool is_inside = true;
+        for(const auto& node_id:pins_[j]){
+            if(!is_member[index_.find(node_id)->second]){
+                is_inside = false;
+                break;
+            }
+        }
+        if(is_inside){
+            weight_of_edges += edge_weights_[j];
+        }
+    }
+    return cmp(weight_of_nodes, 0) > 0 ? (Density<W>)weight_of_edges / weight_of_nodes : 0;
+}
+
+/*
+ * Returns whether the source side of the min cut at rho is a subgraph
+ * denser than rho, and its density if so.
+ */
+template<class W>
+bool ClosureNetwork<W>::Cut(const Density<W> rho, Density<W>& density){
+    int n = node_ids_.size(), m = pins_.get_number_of_lists();
+    int source = 0, sink = 1;
+    Density<W> unbounded = 1;
+    for(const auto& w:edge_weights_){
+        unbounded += w;
+    }
+    delete charge_;
+    delete network_;
+    charge_ = nullptr;
+    network_ = new MaxFlow<Density<W> >(2 + n + m);
+    for(int j = 0; j < m; ++j){
+        network_->AddArc(source, 2 + n + j, edge_weights_[j]);
+        for(const auto& node_id:pins_[j]){
+            network_->AddArc(2 + n + j, 2 + index_.find(node_id)->second, unbounded);
+        }
+    }
+    for(int i = 0; i < n; ++i){
+        network_->AddArc(2 + i, sink, rho * node_weights_[i]);
+    }
+    charge_ = new MemoryCharge("solver", network_->get_bytes());
+    cut_density_ = rho;
+    network_->Run(source, sink);
+    ++number_of_cuts_;
+    is_reachable_ = network_->get_reachable_from(source);
+    is_reaching_ = network_->get_reaching(sink);
+    Weight<W> weight_of_nodes = 0, weight_of_edges = 0;
+    for(int i = 0; i < n; ++i){
+        if(is_reachable_[2 + i]){
+            weight_of_nodes += node_weights_[i];
+        }
+    }
+    for(int j = 0; j < m; ++j){
+        if(is_reachable_[2 + n + j]){
+            weight_of_edges += edge_weights_[j];
+        }
+    }
+    if(cmp(weight_of_nodes, 0) > 0 && cmp((Density<W>)weight_of_edges / weight_of_nodes, rho) > 0){
+        density = (Density<W>)weight_of_edges / weight_of_nodes;
+        return true;
+    }
+    return false;
+}
+
+/*
+ * Dinkelbach iteration from a lower bound rho on the optimum. Given an
+ * upper bound, every other cut bisects the interval instead while it is
+ * wider than kBisectionGap of the bound, and once a subgraph reaches the
+ * upper bound it is densest without another cut, unless the residual graph
+ * at the optimum is needed. Returns false if the budget runs out first;
+ * otherwise rho is optimal.
+ */
+template<class W>
+bool ClosureNetwork<W>::Maximize(Density<W>& rho, const TimeBudget& budget, Density<W> upper, const bool is_residual_needed){
+    const double kBisectionGap = 1e-2;
+    Density<W> density = 0;
+    bool is_bisecting = false;
+    while(true){
+        Density<W> probe = rho;
+        if(is_bisecting && upper >= 0 && cmp(upper - rho, kBisectionGap * upper) > 0){
+            probe = (rho + upper) / 2;
+        }
+        bool is_found = Cut(probe, density);
+        if(is_found){
+            rho = density;
+        }else if(probe == rho){
+            break;
+        }else{
+            upper = probe;
+        }
+        if(budget.is_expired()){
+            return false;
+        }
+        if(is_found && !is_residual_needed && upper >= 0 && cmp(rho, upper) >= 0){
+            break;
+        }
+        is_bisecting = !is_bisecting;
+    }
+    density_ = rho;
+    return true;
+}
+
+template<class W>
+vector<int> ClosureNetwork<W>::get_nodes_of(const vector<bool>& is_marked, const bool value) const{
+    vector<int> ans;
+    for(int i = 0; i < (int)node_ids_.size(); ++i){
+        if(is_marked[2 + i] == value){
+            ans.push_back(node_ids_[i]);
+        }
+    }
+    return ans;
+}
+
+template<class W>
+vector<int> ClosureNetwork<W>::get_source_side() const{
+    return get_nodes_of(is_reachable_, true);
+}
+
+/*
+ * A densest node set once Maximize has returned: the source side of the
+ * last cut if that cut was below the optimum, else the maximal set.
+ */
+template<class W>
+vector<int> ClosureNetwork<W>::get_densest_node_set() const{
+    return cut_density_ < density_ ? get_source_side() : get_maximal_node_set();
+}
+
+template<class W>
+vector<int> ClosureNetwork<W>::get_maximal_node_set() const{
+    return get_nodes_of(is_reaching_, false);
+}
+
+/*
+ * The smallest closed set holding the node: the source side and whatever
+ * the node reaches in the residual graph. Empty if the node reaches the
+ * sink, i.e. lies in no densest subgraph.
+ */
+template<class W>
+vector<int> ClosureNetwork<W>::get_closure(const int node_id) const{
+    int u = 2 + index_.find(node_id)->second;
+    if(is_reaching_[u]){
+        return vector<int>();
+    }
+    vector<bool> is_closed = network_->get_reachable_from(u);
+    for(int i = 0; i < (int)node_ids_.size(); ++i){
+        is_closed[2 + i] = is_closed[2 + i] || is_reachable_[2 + i];
+    }
+    return get_nodes_of(is_closed, true);
+}
+
+/*
+ * The source side if it holds a node, otherwise the sink components of the
+ * residual graph among the vertices that neither the source reaches nor
+ * reach the sink.
+ */
+template<class W>
+vector<vector<int> > ClosureNetwork<W>::get_minimal_node_sets() const{
+    vector<vector<int> > ans;
+    vector<int> source_side = get_source_side();
+    if(!source_side.empty()){
+        ans.push_back(source_side);
+        return ans;
+    }
+    int n = node_ids_.size(), m = pins_.get_number_of_lists();
+    vector<bool> is_free(2 + n + m, false);
+    for(int u = 2; u < 2 + n + m; ++u){
+        is_free[u] = !is_reachable_[u] && !is_reaching_[u];
+    }
+    int number_of_components = 0;
+    vector<int> component = network_->get_components(is_free, number_of_components);
+    vector<bool> is_sink = network_->get_sink_components(is_free, component, number_of_components);
+    vector<vector<int> > nodes_of_component(number_of_components);
+    for(int i = 0; i < n; ++i){
+        if(is_free[2 + i]){
+            nodes_of_component[component[2 + i]].push_back(node_ids_[i]);
+        }
+    }
+    for(int c = 0; c < number_of_components; ++c){
+        if(is_sink[c] && !nodes_of_component[c].empty()){
+            ans.push_back(nodes_of_component[c]);
+        }
+    }
+    return ans;
+}
+
+/**********DensestSubgraphCertificate**********/
+
+template<class W>
+bool DensestSubgraphCertificate<W>::is_unique() const{
+    return minimal_node_sets.size() == 1;
+}
+
+/**********FlowAlgorithm**********/
+
+/*
+ * Search on the closure network between the greedy density and the peeling
+ * upper bound. The last min cut then encodes every densest subgraph: the
+ * minimal ones are the sink components of its residual graph among the
+ * vertices that neither side reaches.
+ */
+template<class W>
+DensestSubgraphCertificate<W> FlowAlgorithm::Solve(const Hypergraph<W>* g){
+    #ifdef DEBUG
+    LOG("");
+    #endif
+
+    MemoryPhase phase("flow");
+    DensestSubgraphCertificate<W> ans;
+    if(g->get_number_of_nodes() == 0){
+        return ans;
+    }
+    PeelingOrder<W> order(g);
+    Density<W> rho = order.get_greedy_density();
+    Hypergraph<W>* g_bar = SeiveByNodeDegree(g, order, rho);
+    ClosureNetwork<W> network(g_bar);
+    delete g_bar;
+    network.Maximize(rho, TimeBudget(), order.get_upper_bound());
+    ans.density = rho;
+    ans.number_of_flows = network.get_number_of_cuts();
+    ans.maximal_node_set = network.get_maximal_node_set();
+    ans.minimal_node_sets = network.get_minimal_node_sets();
+    std::sort(ans.maximal_node_set.begin(), ans.maximal_node_set.end());
+    for(auto& nodes:ans.minimal_node_sets){
+        std::sort(nodes.begin(), nodes.end());
+    }
+    std::sort(ans.minimal_node_sets.begin(), ans.minimal_node_sets.end());
+    return ans;
+}
+
+template class MaxFlow<double>;
+template class MaxFlow<long double>;
+
+#define INSTANTIATE_FLOW(W) \
+template class ClosureNetwork<W>; \
+template struct DensestSubgraphCertificate<W>; \
+template DensestSubgraphCertificate<W> FlowAlgorithm::Solve(const Hypergraph<W>*);
+
+FOR_EACH_WEIGHT_TYPE(INSTANTIATE_FLOW)
@@ -0,0 +1,118 @@
+/*
+ *
+ * For paper 'Finding Subgraphs with Maximum Total Density and Limited Overlap in Weighted Hypergraphs'
+ *
+ * Copyright reserved.
+ *
+ */
+
+#ifndef __FLOW__
+#define __FLOW__
+
+#include "hypergraph.h"
+
+/**********MaxFlow**********/
+
+/*
+ * Dinic's algorithm on a network with capacities of type T. Arcs 2i and
+ * 2i+1 are an arc and its reverse; a residual capacity within kEps of zero
+ * counts as saturated.
+ */
+template<class T>
+class MaxFlow{
+private:
+struct Arc{
+int to;
+T residual;
+};
+vector<Arc> arcs_;
+vector<vector<int> > adjacency_;
+vector<int> level_;
+vector<int> next_;
+bool BuildLevels(const int, const int);
+T Augment(const int, const int);
+
+public:
+MaxFlow(const int);
+int get_number_of_vertices() const;
+long long get_bytes() const;
+void AddArc(const int, const int, const T);
+T Run(const int, const int);
+vector<bool> get_reachable_from(const int) const;
+vector<bool> get_reaching(const int) const;
+vector<int> get_components(const vector<bool>&, int&) const;
+vector<bool> get_sink_components(const vector<bool>&, const vector<int>&, const int) const;
+
+};
+
+/**********ClosureNetwork**********/
+
+/*
+ * The closure network of a hypergraph at a density rho: source -> edge
+ * (w(e)), edge -> pin (unbounded), node -> sink (rho * w(v)). Cut(rho)
+ * builds it and runs one max-flow; the queries then read the residual
+ * graph of that min cut. At the optimal rho the densest node sets are the
+ * closed sets of the residual graph that avoid the vertices reaching the
+ * sink (Picard and Queyranne).
+ */
+template<class W>
+class ClosureNetwork{
+private:
+vector<int> node_ids_;
+vector<Weight<W> > node_weights_;
+CompressedPinLists pins_;
+vector<Weight<W> > edge_weights_;
+HashMap<int, int> index_;
+MaxFlow<Density<W> >* network_;
+MemoryCharge* charge_;
+vector<bool> is_reachable_;
+vector<bool> is_reaching_;
+Density<W> cut_density_;
+Density<W> density_;
+int number_of_cuts_;
+vector<int> get_nodes_of(const vector<bool>&, const bool) const;
+
+public:
+ClosureNetwork(const Hypergraph<W>*);
+ClosureNetwork(const ClosureNetwork&) = delete;
+~ClosureNetwork();
+int get_number_of_nodes() const;
+int get_number_of_cuts() const;
+long long get_bytes() const;
+const vector<int>& get_node_ids() const;
+Weight<W> get_weight_of_nodes(const vector<int>&) const;
+Density<W> get_density(const vector<int>&) const;
+bool Cut(const Density<W>, Density<W>&);
+bool Maximize(Density<W>&, const TimeBudget& = TimeBudget(), Density<W> = -1, const bool is_residual_needed = true);
+vector<int> get_source_side() const;
+vector<int> get_densest_node_set() const;
+vector<int> get_maximal_node_set() const;
+vector<int> get_closure(const int) const;
+vector<vector<int> > get_minimal_node_sets() const;
+};
+
+/**********DensestSubgraphCertificate**********/
+
+/*
+ * Everything one exact solve tells about the densest subgraphs of a graph.
+ * The densest node sets are closed under union and intersection; their
+ * union is the maximal densest subgraph and the minimal ones are disjoint.
+ * The minimal densest subgraph is unique iff there is exactly one of them.
+ */
+template<class W>
+struct DensestSubgraphCertificate{
+Density<W> density = 0;
+int number_of_flows = 0;
+vector<int> maximal_node_set;
+vector<vector<int> > minimal_node_sets;
+bool is_unique() const;
+};
+
+namespace FlowAlgorithm{
+    template<class W>
+    DensestSubgraphCertificate<W> Solve(const Hypergraph<W>*);
+}
+
+// #include "flow.cc"
+
+#endif // __FLOW__
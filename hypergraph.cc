@@ -13,10 +13,156 @@
 #include <sstream>
 #include <iterator>
 #include <cassert>
+#include <new>
+#include <algorithm>
+#include <type_traits>
+#include <unordered_map>
+
+/**********DensityBounds**********/
+
+template<class W>
+bool DensityBounds<W>::has_upper() const{
+    return upper >= 0;
+}
+
+template<class W>
+bool DensityBounds<W>::is_tight() const{
+    return has_upper() && !lower_node_set.empty() && cmp(upper, lower) <= 0;
+}
+
+/**********CompressedIncidence**********/
+
+template<class W>
+CompressedIncidence<W>::CompressedIncidence(const Hypergraph<W>& g){
+    for(const auto& x:g.node_set_){
+        node_ids_.push_back(x.first);
+    }
+    for(const auto& x:g.edge_set_){
+        edge_ids_.push_back(x.first);
+    }
+    std::sort(node_ids_.begin(), node_ids_.end());
+    std::sort(edge_ids_.begin(), edge_ids_.end());
+    HashMap<int, int> node_index, edge_index;
+    for(int i = 0; i < (int)node_ids_.size(); ++i){
+        node_index[node_ids_[i]] = i;
+        node_weights_.push_back(g.node_set_.find(node_ids_[i])->second->get_weight());
+    }
+    for(int j = 0; j < (int)edge_ids_.size(); ++j){
+        edge_index[edge_ids_[j]] = j;
+        edge_weights_.push_back(g.edge_set_.find(edge_ids_[j])->second->get_weight());
+    }
+    vector<int> list;
+    for(const auto& edge_id:edge_ids_){
+        list.clear();
+        for(const auto& node_id:g.edge_set_.find(edge_id)->second->nodes_){
+            list.push_back(node_index.find(node_id)->second);
+        }
+        std::sort(list.begin(), list.end());
+        pins_.Append(list);
+    }
+    for(const auto& node_id:node_ids_){
+        list.clear();
+        for(const auto& edge_id:g.node_set_.find(node_id)->second->edges_){
+            list.push_back(edge_index.find(edge_id)->second);
+        }
+        std::sort(list.begin(), list.end());
+        edges_.Append(list);
+    }
+    pins_.ShrinkToFit();
+    edges_.ShrinkToFit();
+    charge_ = new MemoryCharge("incidence", get_bytes_of_lists() + (long long)node_ids_.size() * (sizeof(int) + sizeof(Weight<W>)) + (long long)edge_ids_.size() * (sizeof(int) + sizeof(Weight<W>)));
+}
+
+template<class W>
+CompressedIncidence<W>::~CompressedIncidence(){
+    delete charge_;
+}
+
+template<class W>
+int CompressedIncidence<W>::get_number_of_nodes() const{
+    return node_ids_.size();
+}
+
+template<class W>
+int CompressedIncidence<W>::get_number_of_edges() const{
+    return edge_ids_.size();
+}
+
+template<class W>
+int64_t CompressedIncidence<W>::get_number_of_pins() const{
+    return pins_.get_number_of_values();
+}
+
+template<class W>
+int CompressedIncidence<W>::get_node_id(const int i) const{
+    return node_ids_[i];
+}
+
+template<class W>
+int CompressedIncidence<W>::get_edge_id(const int j) const{
+    return edge_ids_[j];
+}
+
+template<class W>
+Weight<W> CompressedIncidence<W>::get_weight_of_node(const int i) const{
+    return node_weights_[i];
+}
+
+template<class W>
+Weight<W> CompressedIncidence<W>::get_weight_of_edge(const int j) const{
+    return edge_weights_[j];
+}
+
+/* The numbers of the nodes of edge j, in increasing order. */
+template<class W>
+CompressedPinLists::List CompressedIncidence<W>::get_pins(const int j) const{
+    return pins_[j];
+}
+
+/* The numbers of the edges of node i, in increasing order. */
+template<class W>
+CompressedPinLists::List CompressedIncidence<W>::get_edges(const int i) const{
+    return edges_[i];
+}
+
+template<class W>
+int64_t CompressedIncidence<W>::get_bytes_of_lists() const{
+    return pins_.get_bytes() + edges_.get_bytes();
+}
+
+/* Both lists as plain ints with an offset per list. */
+template<class W>
+int64_t CompressedIncidence<W>::get_bytes_of_plain_lists() const{
+    return 2 * get_number_of_pins() * (int64_t)sizeof(int) + (int64_t)(node_ids_.size() + edge_ids_.size()) * (int64_t)sizeof(int64_t);
+}
+
+/*
+ * Pins decoded per second over one pass through both lists.
+ */
+template<class W>
+double CompressedIncidence<W>::MeasureDecoding() const{
+    auto start = std::chrono::steady_clock::now();
+    long long sum = 0;
+    for(int j = 0; j < (int)edge_ids_.size(); ++j){
+        for(const auto& i:pins_[j]){
+            sum += i;
+        }
+    }
+    for(int i = 0; i < (int)node_ids_.size(); ++i){
+        for(const auto& j:edges_[i]){
+            sum += j;
+        }
+    }
+    volatile long long sink = sum;
+    (void)sink;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds > 0 ? 2 * get_number_of_pins() / seconds : 0;
+}
 
 /**********Node**********/
 
-bool Node::Read(Input& input, int& id, ld& weight){
+template<class W>
+bool Node<W>::Read(Input& input, int& id, Weight<W>& weight){
     std::stringstream ss;
     if(!input.NextLine(ss)){
         return false;
@@ -30,25 +176,39 @@ bool Node::Read(Input& input, int& id, ld& weight){
     return true;
 }
 
-Node::Node(const int id): id_(id){weight_ = weight_of_edges_ = 0;}
+template<class W>
+Node<W>::Node(const int id, Arena* arena): id_(id), position_(-1), edges_(0, std::hash<int>(), std::equal_to<int>(), ArenaAllocator<int>(arena)){weight_ = weight_of_edges_ = 0;}
 
-int Node::get_id() const{
+template<class W>
+Node<W>::Node(const Node& node, Arena* arena): id_(node.id_), position_(node.position_), weight_(node.weight_), weight_of_edges_(node.weight_of_edges_), edges_(node.edges_, ArenaAllocator<int>(arena)){}
+
+template<class W>
+int Node<W>::get_id() const{
     return id_;
 }
 
-ld Node::get_weight() const{
+template<class W>
+Weight<W> Node<W>::get_weight() const{
     return weight_;
 }
 
-void Node::set_weight(const ld weight){
+template<class W>
+Weight<W> Node<W>::get_weight_of_edges() const{
+    return weight_of_edges_;
+}
+
+template<class W>
+void Node<W>::set_weight(const Weight<W> weight){
     weight_ = weight;
 }
 
-bool Node::has_edge(const int edge_id) const{
+template<class W>
+bool Node<W>::has_edge(const int edge_id) const{
     return edges_.find(edge_id) != edges_.end();
 }
 
-void Node::Connect(const int edge_id, const ld edge_weight){
+template<class W>
+void Node<W>::Connect(const int edge_id, const Weight<W> edge_weight){
     #ifndef NVAL
     if(has_edge(edge_id)){
         return;
@@ -58,11 +218,13 @@ void Node::Connect(const int edge_id, const ld edge_weight){
     weight_of_edges_ += edge_weight;
 }
 
-void Node::Connect(const Edge& edge){
+template<class W>
+void Node<W>::Connect(const Edge<W>& edge){
     Connect(edge.get_id(), edge.get_weight());
 }
 
-void Node::Cut(const int edge_id, const ld edge_weight){
+template<class W>
+void Node<W>::Cut(const int edge_id, const Weight<W> edge_weight){
     #ifndef NVAL
     if(!has_edge(edge_id)){
         return;
@@ -72,18 +234,21 @@ void Node::Cut(const int edge_id, const ld edge_weight){
     weight_of_edges_ -= edge_weight;
 }
 
-void Node::Cut(const Edge&edge){
+template<class W>
+void Node<W>::Cut(const Edge<W>& edge){
     Cut(edge.get_id(), edge.get_weight());
 }
 
-ld Node::get_degree() const{
+template<class W>
+Density<W> Node<W>::get_degree() const{
     if(cmp(weight_, 0) == 0){
         return 0;
     }
-    return weight_of_edges_ / weight_;
+    return (Density<W>)weight_of_edges_ / weight_;
 }
 
-string Node::Show() const{
+template<class W>
+string Node<W>::Show() const{
     string info = "node(" + Int2String(id_) +"){ ";
     for(const auto& x:edges_){
         info += Int2String(x) + " ";
@@ -93,18 +258,21 @@ string Node::Show() const{
     return info;
 }
 
-string Node::ToFile() const{
+template<class W>
+string Node<W>::ToFile() const{
     string info = Int2String(id_) + " " + Int2String(weight_);
     return info;
 }
 
-int Node::get_unweighted_degree() const{
+template<class W>
+int Node<W>::get_unweighted_degree() const{
     return edges_.size();
 }
 
 /**********Edge**********/
 
-bool Edge::Read(Input& input, ld& weight, vector<int>& ids){
+template<class W>
+bool Edge<W>::Read(Input& input, Weight<W>& weight, vector<int>& ids){
     std::stringstream ss;
     if(!input.NextLine(ss)){
         return false;
@@ -136,25 +304,34 @@ bool Edge::Read(Input& input, ld& weight, vector<int>& ids){
     return true;
 }
 
-Edge::Edge(const int id): id_(id){weight_ = 0;}
+template<class W>
+Edge<W>::Edge(const int id, Arena* arena): id_(id), nodes_(0, std::hash<int>(), std::equal_to<int>(), ArenaAllocator<int>(arena)){weight_ = 0;}
 
-int Edge::get_id() const{
+template<class W>
+Edge<W>::Edge(const Edge& edge, Arena* arena): id_(edge.id_), weight_(edge.weight_), nodes_(edge.nodes_, ArenaAllocator<int>(arena)){}
+
+template<class W>
+int Edge<W>::get_id() const{
     return id_;
 }
 
-ld Edge::get_weight() const{
+template<class W>
+Weight<W> Edge<W>::get_weight() const{
     return weight_;
 }
 
-void Edge::set_weight(const ld weight){
+template<class W>
+void Edge<W>::set_weight(const Weight<W> weight){
     weight_ = weight;
 }
 
-bool Edge::has_node(const int node_id) const{
+template<class W>
+bool Edge<W>::has_node(const int node_id) const{
     return nodes_.find(node_id) != nodes_.end();
 }
 
-void Edge::Connect(const int node_id){
+template<class W>
+void Edge<W>::Connect(const int node_id){
     #ifndef NVAL
     if(has_node(node_id)){
         return;
@@ -163,11 +340,13 @@ void Edge::Connect(const int node_id){
     nodes_.insert(node_id);
 }
 
-void Edge::Connect(const Node& node){
+template<class W>
+void Edge<W>::Connect(const Node<W>& node){
     Connect(node.get_id());
 }
 
-void Edge::Cut(const int node_id){
+template<class W>
+void Edge<W>::Cut(const int node_id){
     #ifndef NVAL
     if(!has_node(node_id)){
         return;
@@ -176,11 +355,13 @@ void Edge::Cut(const int node_id){
     nodes_.erase(node_id);
 }
 
-void Edge::Cut(const Node& node){
+template<class W>
+void Edge<W>::Cut(const Node<W>& node){
     Cut(node.get_id());
 }
 
-string Edge::Show() const{
+template<class W>
+string Edge<W>::Show() const{
     string ans = "edge(" + Int2String(id_) + "){ ";
     for(const auto& x:nodes_){
         ans += Int2String(x) + " ";
@@ -190,7 +371,8 @@ string Edge::Show() const{
     return ans;
 }
 
-string Edge::ToFile() const{
+template<class W>
+string Edge<W>::ToFile() const{
     string ans = "";
     for(const auto& x:nodes_){
         ans += Int2String(x) + ",";
@@ -200,44 +382,201 @@ string Edge::ToFile() const{
     return ans;
 }
 
-vector<int> Edge::get_nodes_id() const{
+template<class W>
+vector<int> Edge<W>::get_nodes_id() const{
     vector<int> vec;
     for(const auto& x:nodes_)
         vec.push_back(x);
     return vec;
 }
 
+/**********Node<Unweighted>**********/
+
+bool Node<Unweighted>::Read(Input& input, int& id, Weight<Unweighted>& weight){
+    double ignored;
+    if(!Node<double>::Read(input, id, ignored)){
+        return false;
+    }
+    weight = 1;
+    return true;
+}
+
+Node<Unweighted>::Node(const int id, Arena* arena): id_(id), position_(-1), edges_(0, std::hash<int>(), std::equal_to<int>(), ArenaAllocator<int>(arena)){}
+
+Node<Unweighted>::Node(const Node& node, Arena* arena): id_(node.id_), position_(node.position_), edges_(node.edges_, ArenaAllocator<int>(arena)){}
+
+int Node<Unweighted>::get_id() const{
+    return id_;
+}
+
+Weight<Unweighted> Node<Unweighted>::get_weight() const{
+    return 1;
+}
+
+Weight<Unweighted> Node<Unweighted>::get_weight_of_edges() const{
+    return edges_.size();
+}
+
+void Node<Unweighted>::set_weight(const Weight<Unweighted>){}
+
+bool Node<Unweighted>::has_edge(const int edge_id) const{
+    return edges_.find(edge_id) != edges_.end();
+}
+
+void Node<Unweighted>::Connect(const int edge_id, const Weight<Unweighted>){
+    edges_.insert(edge_id);
+}
+
+void Node<Unweighted>::Connect(const Edge<Unweighted>& edge){
+    Connect(edge.get_id(), 1);
+}
+
+void Node<Unweighted>::Cut(const int edge_id, const Weight<Unweighted>){
+    edges_.erase(edge_id);
+}
+
+void Node<Unweighted>::Cut(const Edge<Unweighted>& edge){
+    Cut(edge.get_id(), 1);
+}
+
+Density<Unweighted> Node<Unweighted>::get_degree() const{
+    return edges_.size();
+}
+
+string Node<Unweighted>::Show() const{
+    string info = "node(" + Int2String(id_) +"){ ";
+    for(const auto& x:edges_){
+        info += Int2String(x) + " ";
+    }
+    info += "} - ";
+    info += Double2String(1);
+    return info;
+}
+
+string Node<Unweighted>::ToFile() const{
+    return Int2String(id_) + " 1";
+}
+
+int Node<Unweighted>::get_unweighted_degree() const{
+    return edges_.size();
+}
+
+/**********Edge<Unweighted>**********/
+
+bool Edge<Unweighted>::Read(Input& input, Weight<Unweighted>& weight, vector<int>& ids){
+    double ignored;
+    if(!Edge<double>::Read(input, ignored, ids)){
+        return false;
+    }
+    weight = 1;
+    return true;
+}
+
+Edge<Unweighted>::Edge(const int id, Arena* arena): id_(id), nodes_(0, std::hash<int>(), std::equal_to<int>(), ArenaAllocator<int>(arena)){}
+
+Edge<Unweighted>::Edge(const Edge& edge, Arena* arena): id_(edge.id_), nodes_(edge.nodes_, ArenaAllocator<int>(arena)){}
+
+int Edge<Unweighted>::get_id() const{
+    return id_;
+}
+
+Weight<Unweighted> Edge<Unweighted>::get_weight() const{
+    return 1;
+}
+
+void Edge<Unweighted>::set_weight(const Weight<Unweighted>){}
+
+bool Edge<Unweighted>::has_node(const int node_id) const{
+    return nodes_.find(node_id) != nodes_.end();
+}
+
+void Edge<Unweighted>::Connect(const int node_id){
+    nodes_.insert(node_id);
+}
+
+void Edge<Unweighted>::Connect(const Node<Unweighted>& node){
+    Connect(node.get_id());
+}
+
+void Edge<Unweighted>::Cut(const int node_id){
+    nodes_.erase(node_id);
+}
+
+void Edge<Unweighted>::Cut(const Node<Unweighted>& node){
+    Cut(node.get_id());
+}
+
+string Edge<Unweighted>::Show() const{
+    string ans = "edge(" + Int2String(id_) + "){ ";
+    for(const auto& x:nodes_){
+        ans += Int2String(x) + " ";
+    }
+    ans += "} - ";
+    ans += Double2String(1);
+    return ans;
+}
+
+string Edge<Unweighted>::ToFile() const{
+    string ans = "";
+    for(const auto& x:nodes_){
+        ans += Int2String(x) + ",";
+    }
+    ans[ans.length()-1]=' ';
+    ans += "1";
+    return ans;
+}
+
+vector<int> Edge<Unweighted>::get_nodes_id() const{
+    return vector<int>(nodes_.begin(), nodes_.end());
+}
+
 /**********Hypergraph**********/
 
-void Hypergraph::Clear(){
+template<class W>
+void Hypergraph<W>::Clear(){
     number_of_nodes_ = number_of_edges_ = 0;
     avl_edge_id = 0;
-    for(auto& x:node_set_){
-        delete x.second;
-    }
-    for(auto& x:edge_set_){
-        delete x.second;
-    }
     node_set_.clear();  edge_set_.clear();
+    dense_node_ids_.clear();
+    incidence_.reset();
+    shares_objects_ = false;
+    own_nodes_.clear();
+    if(owns_arena_){
+        arena_->Release();
+    }
     weight_of_nodes_ = weight_of_edges_ = 0;
 }
 
-Node* Hypergraph::AddNode(const int node_id, const ld node_weight){
+template<class W>
+Node<W>* Hypergraph<W>::AddNode(const int node_id, const Weight<W> node_weight){
     //assert(has_node(node_id) == false);
-    Node* u = new Node(node_id);
+    incidence_.reset();
+    if(shares_objects_){
+        own_nodes_.insert(node_id);
+    }
+    Node<W>* u = new (arena_->Allocate(sizeof(Node<W>), alignof(Node<W>))) Node<W>(node_id, arena_);
     u->set_weight(node_weight);
+    auto x = node_set_.find(node_id);
+    if(x != node_set_.end()){
+        u->position_ = x->second->position_;
+    }else{
+        u->position_ = dense_node_ids_.size();
+        dense_node_ids_.push_back(node_id);
+    }
     node_set_[node_id] = u;
-    weight_of_nodes_ += node_weight;
+    weight_of_nodes_ += u->get_weight();
     ++number_of_nodes_;
     return u;
 }
 
-Edge* Hypergraph::AddEdge(const vector<int>& nodes, const ld edge_weight, const int edge_id){
+template<class W>
+Edge<W>* Hypergraph<W>::AddEdge(const vector<int>& nodes, const Weight<W> edge_weight, const int edge_id){
     assert(edge_id >= 0);
-    Edge* e = new Edge(edge_id);
+    incidence_.reset();
+    Edge<W>* e = new (arena_->Allocate(sizeof(Edge<W>), alignof(Edge<W>))) Edge<W>(edge_id, arena_);
     e->set_weight(edge_weight);
     edge_set_[edge_id] = e;
-    weight_of_edges_ += edge_weight;
+    weight_of_edges_ += e->get_weight();
     ++number_of_edges_;
 
     for(auto node_id:nodes){
@@ -245,66 +584,206 @@ Edge* Hypergraph::AddEdge(const vector<int>& nodes, const ld edge_weight, const
         if(!has_node(node_id))  Console::Error("Undefined Node.");
         #endif
         e->Connect(*node_set_[node_id]);
-        node_set_[node_id]->Connect(*e);
+        get_own_node(node_id)->Connect(*e);
     }
     return e;
 }
 
-int Hypergraph::get_assigned_edge_id(){
+template<class W>
+int Hypergraph<W>::get_assigned_edge_id(){
     while(has_edge(avl_edge_id))    ++avl_edge_id;
     return avl_edge_id;
 }
 
-void Hypergraph::EraseNode(const int node_id){
+template<class W>
+void Hypergraph<W>::EraseNode(const int node_id){
     #ifndef NVAL
     if(!has_node(node_id)){
         return;
     }
     #endif
     auto u = node_set_[node_id];
-    set edge_set_to_be_deleted = u->edges_;
+    std::shared_ptr<const CompressedIncidence<W> > incidence = incidence_;
+    vector<int> edge_set_to_be_deleted(u->edges_.begin(), u->edges_.end());
     for(const auto& edge_id:edge_set_to_be_deleted){
         EraseEdge(edge_id);
     }
     weight_of_nodes_ -= u->get_weight();
-    node_set_.erase(node_id);
+    DetachNode(node_id);
     --number_of_nodes_;
-    delete u;
+    /* Still an induced subgraph of the graph of the incidence. */
+    incidence_ = incidence;
+}
+
+/*
+ * Drops the node from the index; the last node of the dense array takes
+ * its place, so sampling and removal both stay O(1).
+ */
+template<class W>
+void Hypergraph<W>::DetachNode(const int node_id){
+    incidence_.reset();
+    int position = node_set_[node_id]->position_;
+    int last = dense_node_ids_.back();
+    dense_node_ids_[position] = last;
+    if(last != node_id){
+        get_own_node(last)->position_ = position;
+    }
+    dense_node_ids_.pop_back();
+    node_set_.erase(node_id);
+    own_nodes_.erase(node_id);
+}
+
+/*
+ * The node object to change; a residual graph first copies a node it
+ * still shares with its source into its own arena.
+ */
+template<class W>
+Node<W>* Hypergraph<W>::get_own_node(const int node_id){
+    Node<W>*& u = node_set_[node_id];
+    if(shares_objects_ && own_nodes_.insert(node_id).second){
+        u = new (arena_->Allocate(sizeof(Node<W>), alignof(Node<W>))) Node<W>(*u, arena_);
+    }
+    return u;
 }
 
-void Hypergraph::EraseEdge(const int edge_id){
+template<class W>
+void Hypergraph<W>::EraseEdge(const int edge_id){
     #ifndef NVAL
     if(!has_edge(edge_id)){
         return;
     }
     #endif
+    incidence_.reset();
     auto e = edge_set_[edge_id];
     for(const auto& node_id:e->nodes_){
-        node_set_[node_id]->Cut(*e);
+        get_own_node(node_id)->Cut(*e);
     }
     weight_of_edges_ -= e->get_weight();
     edge_set_.erase(edge_id);
     --number_of_edges_;
-    delete e;
 }
 
-Hypergraph::Hypergraph(Input node_input, Input edge_input){
+/*
+ * An empty graph with its own arena, filled by friends through AddNode and
+ * AddEdge.
+ */
+template<class W>
+Hypergraph<W>::Hypergraph(): Hypergraph("graph"){}
+
+/* An empty graph whose arena is charged to the given category. */
+template<class W>
+Hypergraph<W>::Hypergraph(const char* category): arena_(new Arena(1 << 16, category)), owns_arena_(true), bytes_of_index_(0){
+    Clear();
+}
+
+/*
+ * With is_merging, the pins of every edge are sorted and deduplicated and
+ * edges with the same pins become one edge carrying the sum of their
+ * weights, which leaves the weight of every induced subgraph unchanged.
+ * Edge ids then number the distinct edges in order of first appearance.
+ * Unweighted graphs cannot hold the sums and are never merged.
+ */
+template<class W>
+Hypergraph<W>::Hypergraph(Input node_input, Input edge_input, const bool is_merging): arena_(new Arena()), owns_arena_(true){
     Clear();
+    if(is_merging && std::is_same<W, Unweighted>::value){
+        Console::Error("Parallel edges can't be merged in an unweighted hypergraph.");
+    }
 
     int node_id;
-    ld node_weight;
-    while(Node::Read(node_input, node_id, node_weight)){
+    Weight<W> node_weight;
+    while(Node<W>::Read(node_input, node_id, node_weight)){
         AddNode(node_id, node_weight);
     }
 
-    ld edge_weight;
+    Weight<W> edge_weight;
     vector<int> nodes;
-    while(Edge::Read(edge_input, edge_weight, nodes)){
-        AddEdge(nodes, edge_weight, get_assigned_edge_id());
+    std::unordered_multimap<uint64_t, int> edges_of_hash;
+    int number_of_merged_edges = 0;
+    while(Edge<W>::Read(edge_input, edge_weight, nodes)){
+        if(!is_merging){
+            AddEdge(nodes, edge_weight, get_assigned_edge_id());
+            continue;
+        }
+        std::sort(nodes.begin(), nodes.end());
+        nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+        uint64_t hash = 14695981039346656037ULL;
+        for(const auto& x:nodes){
+            hash = (hash ^ (uint32_t)x) * 1099511628211ULL;
+        }
+        Edge<W>* e = nullptr;
+        auto range = edges_of_hash.equal_range(hash);
+        for(auto x = range.first; x != range.second && e == nullptr; ++x){
+            Edge<W>* candidate = edge_set_[x->second];
+            if(candidate->nodes_.size() != nodes.size()){
+                continue;
+            }
+            bool is_same = true;
+            for(const auto& y:nodes){
+                if(!candidate->has_node(y)){
+                    is_same = false;
+                    break;
+                }
+            }
+            if(is_same){
+                e = candidate;
+            }
+        }
+        if(e == nullptr){
+            int edge_id = get_assigned_edge_id();
+            AddEdge(nodes, edge_weight, edge_id);
+            edges_of_hash.emplace(hash, edge_id);
+            continue;
+        }
+        for(const auto& x:e->nodes_){
+            node_set_[x]->Cut(*e);
+        }
+        e->set_weight(e->get_weight() + edge_weight);
+        for(const auto& x:e->nodes_){
+            node_set_[x]->Connect(*e);
+        }
+        weight_of_edges_ += edge_weight;
+        ++number_of_merged_edges;
+    }
+    if(number_of_merged_edges > 0){
+        Console::Show("Merged " + Int2String(number_of_merged_edges) + " parallel edges into " + Int2String(number_of_edges_) + " distinct edges.");
+    }
+    bytes_of_index_ = get_bytes_of_index();
+    MemoryTracker::Charge(arena_->get_category(), bytes_of_index_);
+}
+
+template<class W>
+Hypergraph<W>::Hypergraph(const Hypergraph& graph): Hypergraph(graph, nullptr){}
+
+template<class W>
+Hypergraph<W>::Hypergraph(const Hypergraph& graph, Arena* arena): Hypergraph(graph, arena, graph.layout_){}
+
+/*
+ * Copies object into the arena for every id of objects, in the order of
+ * layout when the map still holds a good part of it and in map order
+ * otherwise. The map itself is left as it was.
+ */
+template<class T>
+static void CopyObjects(HashMap<int, T*>& objects, Arena* arena, const vector<int>* layout){
+    if(layout != nullptr && objects.size() * 4 >= layout->size()){
+        for(const auto& id:*layout){
+            auto it = objects.find(id);
+            if(it != objects.end()){
+                it->second = new (arena->Allocate(sizeof(T), alignof(T))) T(*it->second, arena);
+            }
+        }
+        return;
+    }
+    for(auto& x:objects){
+        x.second = new (arena->Allocate(sizeof(T), alignof(T))) T(*x.second, arena);
     }
 }
 
-Hypergraph::Hypergraph(const Hypergraph& graph){
+template<class W>
+Hypergraph<W>::Hypergraph(const Hypergraph& graph, Arena* arena, const std::shared_ptr<const Layout> layout): arena_(arena), owns_arena_(arena == nullptr){
+    if(owns_arena_){
+        arena_ = new Arena(1 << 16, "copy");
+    }
     Clear();
 
     /*for(const auto& x:graph.node_set_){
@@ -319,58 +798,97 @@ Hypergraph::Hypergraph(const Hypergraph& graph){
     number_of_nodes_ = graph.number_of_nodes_;
     number_of_edges_ = graph.number_of_edges_;
     node_set_ = graph.node_set_;
-    for(auto& x:node_set_){
-        x.second = new Node(*x.second);
-    }
+    CopyObjects(node_set_, arena_, layout == nullptr ? nullptr : &layout->node_ids);
     edge_set_ = graph.edge_set_;
-    for(auto& x:edge_set_){
-        x.second = new Edge(*x.second);
+    CopyObjects(edge_set_, arena_, layout == nullptr ? nullptr : &layout->edge_ids);
+    for(const auto& x:edge_set_){
         avl_edge_id = x.first + 1;
     }
+    /* Copies sample in id order, whatever the removal history of graph. */
+    dense_node_ids_.reserve(node_set_.size());
+    for(const auto& x:node_set_){
+        dense_node_ids_.push_back(x.first);
+    }
+    std::sort(dense_node_ids_.begin(), dense_node_ids_.end());
+    for(int i = 0; i < (int)dense_node_ids_.size(); ++i){
+        node_set_[dense_node_ids_[i]]->position_ = i;
+    }
     weight_of_edges_ = graph.weight_of_edges_;
     weight_of_nodes_ = graph.weight_of_nodes_;
+    layout_ = layout;
+    incidence_ = graph.incidence_;
+    bytes_of_index_ = get_bytes_of_index();
+    MemoryTracker::Charge(arena_->get_category(), bytes_of_index_);
 }
 
-Hypergraph::~Hypergraph(){
+template<class W>
+Hypergraph<W>::~Hypergraph(){
+    MemoryTracker::Release(arena_->get_category(), bytes_of_index_);
     Clear();
+    if(owns_arena_){
+        delete arena_;
+    }
+}
+
+/*
+ * The hash maps of nodes and edges live outside the arena: one pointer per
+ * bucket and one heap node per entry.
+ */
+template<class W>
+long long Hypergraph<W>::get_bytes_of_index() const{
+    return (long long)(node_set_.bucket_count() + edge_set_.bucket_count()) * sizeof(void*) + (long long)(node_set_.size() + edge_set_.size()) * (sizeof(void*) + sizeof(std::pair<int, void*>) + sizeof(size_t)) + (long long)dense_node_ids_.capacity() * sizeof(int);
 }
 
-bool Hypergraph::is_empty() const{
+template<class W>
+bool Hypergraph<W>::is_empty() const{
     return number_of_nodes_ == 0 && number_of_edges_ == 0;
 }
 
-bool Hypergraph::has_node(const int node_id) const{
+template<class W>
+bool Hypergraph<W>::has_node(const int node_id) const{
     return node_set_.find(node_id) != node_set_.end();
 }
 
-bool Hypergraph::has_edge(const int edge_id) const{
+template<class W>
+bool Hypergraph<W>::has_edge(const int edge_id) const{
     return edge_set_.find(edge_id) != edge_set_.end();
 }
 
-int Hypergraph::get_number_of_nodes() const{
+template<class W>
+int Hypergraph<W>::get_number_of_nodes() const{
     return number_of_nodes_;
 }
 
-int Hypergraph::get_number_of_edges() const{
+template<class W>
+int Hypergraph<W>::get_number_of_edges() const{
     return number_of_edges_;
 }
 
-ld Hypergraph::get_degree_of_node(const int node_id){
+template<class W>
+Density<W> Hypergraph<W>::get_degree_of_node(const int node_id){
     return node_set_[node_id]->get_degree();
 }
 
-ld Hypergraph::get_weight_of_nodes() const{
+template<class W>
+Weight<W> Hypergraph<W>::get_weight_of_nodes() const{
     return weight_of_nodes_;
 }
 
-ld Hypergraph::get_density() const{
+template<class W>
+Weight<W> Hypergraph<W>::get_weight_of_edges() const{
+    return weight_of_edges_;
+}
+
+template<class W>
+Density<W> Hypergraph<W>::get_density() const{
     if(cmp(weight_of_nodes_, 0) == 0){
         return 0;
     }
-    return weight_of_edges_ / weight_of_nodes_;
+    return (Density<W>)weight_of_edges_ / weight_of_nodes_;
 }
 
-set Hypergraph::get_node_set() const{
+template<class W>
+set Hypergraph<W>::get_node_set() const{
     set ans;
     for(const auto& x:node_set_){
         ans.insert(x.first);
@@ -378,21 +896,54 @@ set Hypergraph::get_node_set() const{
     return ans;
 }
 
-int Hypergraph::get_random_node_id() const{
+template<class W>
+void Hypergraph<W>::GetNodeWeights(vector<int>& node_ids, vector<Weight<W> >& weights, vector<Weight<W> >& weights_of_edges) const{
+    node_ids.clear();
+    weights.clear();
+    weights_of_edges.clear();
+    for(const auto& x:node_set_){
+        node_ids.push_back(x.first);
+        weights.push_back(x.second->get_weight());
+        weights_of_edges.push_back(x.second->get_weight_of_edges());
+    }
+}
+
+template<class W>
+void Hypergraph<W>::GetEdges(vector<vector<int> >& pins, vector<Weight<W> >& weights) const{
+    pins.clear();
+    weights.clear();
+    for(const auto& x:edge_set_){
+        pins.push_back(x.second->get_nodes_id());
+        weights.push_back(x.second->get_weight());
+    }
+}
+
+template<class W>
+void Hypergraph<W>::GetEdges(CompressedPinLists& pins, vector<Weight<W> >& weights) const{
+    pins = CompressedPinLists();
+    weights.clear();
+    for(const auto& x:edge_set_){
+        pins.Append(x.second->get_nodes_id());
+        weights.push_back(x.second->get_weight());
+    }
+    pins.ShrinkToFit();
+}
+
+template<class W>
+int Hypergraph<W>::get_random_node_id() const{
     assert(number_of_nodes_ > 0);
-    int rank = get_random_value(0, number_of_nodes_ - 1);
-    auto x = node_set_.begin();
-    std::advance(x, rank);
-    return x->first;
+    return dense_node_ids_[get_random_value(0, dense_node_ids_.size())];
 }
 
-void Hypergraph::RemoveNodeSet(const set node_set){
+template<class W>
+void Hypergraph<W>::RemoveNodeSet(const set node_set){
     for(const auto& node_id:node_set){
         EraseNode(node_id);
     }
 }
 
-Hypergraph* Hypergraph::GenerateComplement(const Hypergraph& subgraph, const Hypergraph& graph){
+template<class W>
+Hypergraph<W>* Hypergraph<W>::GenerateComplement(const Hypergraph& subgraph, const Hypergraph& graph){
     Hypergraph* complement = new Hypergraph(subgraph);
     auto edge_set_to_be_deleted = complement->edge_set_;
     for(const auto& x:edge_set_to_be_deleted){
@@ -403,7 +954,7 @@ Hypergraph* Hypergraph::GenerateComplement(const Hypergraph& subgraph, const Hyp
         if(subgraph.has_edge(edge_id)){
             continue;
         }
-        Edge* e = x.second;
+        Edge<W>* e = x.second;
         vector<int> node_set;
         for(const auto& node_id:e->nodes_){
             if(subgraph.has_node(node_id)){
@@ -417,14 +968,15 @@ Hypergraph* Hypergraph::GenerateComplement(const Hypergraph& subgraph, const Hyp
     return complement;
 }
 
-Hypergraph* Hypergraph::GenerateInducement(const Hypergraph& subgraph, const Hypergraph& graph){
+template<class W>
+Hypergraph<W>* Hypergraph<W>::GenerateInducement(const Hypergraph& subgraph, const Hypergraph& graph){
     Hypergraph* inducement = new Hypergraph(subgraph);
     auto edge_set_to_be_deleted = inducement->edge_set_;
     for(const auto& x:edge_set_to_be_deleted){
         inducement->EraseEdge(x.first);
     }
     for(const auto& x:graph.edge_set_){
-        Edge* e = x.second;
+        Edge<W>* e = x.second;
         vector<int> node_set;
         for(const auto& node_id:e->nodes_){
             if(subgraph.has_node(node_id)){
@@ -438,7 +990,225 @@ Hypergraph* Hypergraph::GenerateInducement(const Hypergraph& subgraph, const Hyp
     return inducement;
 }
 
-string Hypergraph::Show() const{
+/*
+ * A copy with nodes and edges allocated in an order chosen for locality:
+ * "degree" puts nodes by decreasing degree, "bfs" in breadth-first order
+ * over the incidence graph from the highest-degree node of every
+ * component, and "rcm" in reverse Cuthill-McKee order. Edges follow their
+ * first node. Ids, map order and sampling order are those of this graph,
+ * so only the memory layout changes, never a result.
+ */
+template<class W>
+Hypergraph<W>* Hypergraph<W>::GenerateReordering(const string way) const{
+    if(way != "degree" && way != "bfs" && way != "rcm"){
+        Console::Error("Unknown reordering <" + way + ">.");
+    }
+    vector<int> node_ids, edge_ids;
+    vector<vector<int> > pins;
+    HashMap<int, int> index;
+    for(const auto& x:node_set_){
+        index[x.first] = node_ids.size();
+        node_ids.push_back(x.first);
+    }
+    for(const auto& x:edge_set_){
+        edge_ids.push_back(x.first);
+        pins.push_back(vector<int>());
+        for(const auto& node_id:x.second->nodes_){
+            pins.back().push_back(index[node_id]);
+        }
+    }
+    int n = node_ids.size(), m = edge_ids.size();
+    vector<vector<int> > incidence(n);
+    for(int j = 0; j < m; ++j){
+        for(const auto& v:pins[j]){
+            incidence[v].push_back(j);
+        }
+    }
+    auto is_before = [&](const int u, const int v){
+        return incidence[u].size() != incidence[v].size() ? incidence[u].size() > incidence[v].size() : node_ids[u] < node_ids[v];
+    };
+    vector<int> order(n);
+    for(int v = 0; v < n; ++v){
+        order[v] = v;
+    }
+    std::sort(order.begin(), order.end(), is_before);
+    if(way != "degree"){
+        bool is_rcm = way == "rcm";
+        if(is_rcm){
+            std::reverse(order.begin(), order.end());
+        }
+        vector<bool> is_visited(n, false), is_expanded(m, false);
+        vector<int> queue;
+        queue.reserve(n);
+        for(const auto& root:order){
+            if(is_visited[root]){
+                continue;
+            }
+            is_visited[root] = true;
+            queue.push_back(root);
+            for(int head = queue.size() - 1; head < (int)queue.size(); ++head){
+                int tail = queue.size();
+                for(const auto& j:incidence[queue[head]]){
+                    if(is_expanded[j]){
+                        continue;
+                    }
+                    is_expanded[j] = true;
+                    for(const auto& v:pins[j]){
+                        if(!is_visited[v]){
+                            is_visited[v] = true;
+                            queue.push_back(v);
+                        }
+                    }
+                }
+                if(is_rcm){
+                    std::sort(queue.begin() + tail, queue.end(), [&](const int u, const int v){return is_before(v, u);});
+                }
+            }
+        }
+        if(is_rcm){
+            std::reverse(queue.begin(), queue.end());
+        }
+        order.swap(queue);
+    }
+    vector<int> rank(n);
+    for(int i = 0; i < n; ++i){
+        rank[order[i]] = i;
+    }
+    vector<int> first_node(m, n), edge_order(m);
+    for(int j = 0; j < m; ++j){
+        for(const auto& v:pins[j]){
+            first_node[j] = std::min(first_node[j], rank[v]);
+        }
+        edge_order[j] = j;
+    }
+    std::sort(edge_order.begin(), edge_order.end(), [&](const int x, const int y){
+        return first_node[x] != first_node[y] ? first_node[x] < first_node[y] : edge_ids[x] < edge_ids[y];
+    });
+
+    Layout* layout = new Layout();
+    for(int i = 0; i < n; ++i){
+        layout->node_ids.push_back(node_ids[order[i]]);
+    }
+    for(int i = 0; i < m; ++i){
+        layout->edge_ids.push_back(edge_ids[edge_order[i]]);
+    }
+    Hypergraph* ans = new Hypergraph(*this, nullptr, std::shared_ptr<const Layout>(layout));
+    ans->avl_edge_id = avl_edge_id;
+    ans->dense_node_ids_ = dense_node_ids_;
+    for(const auto& x:node_set_){
+        ans->node_set_[x.first]->position_ = x.second->position_;
+    }
+    return ans;
+}
+
+/*
+ * A copy that shares the node and edge objects of this graph instead of
+ * copying them, so removing a subgraph from it costs the nodes that lose
+ * an edge rather than a copy of the whole graph. It samples in id order
+ * like a copy. This graph must outlive it and stay unchanged meanwhile.
+ */
+template<class W>
+Hypergraph<W>* Hypergraph<W>::GenerateResidual() const{
+    Hypergraph* ans = new Hypergraph("residual");
+    ans->shares_objects_ = true;
+    ans->number_of_nodes_ = number_of_nodes_;
+    ans->number_of_edges_ = number_of_edges_;
+    ans->node_set_ = node_set_;
+    ans->edge_set_ = edge_set_;
+    for(const auto& x:edge_set_){
+        ans->avl_edge_id = x.first + 1;
+    }
+    ans->dense_node_ids_ = dense_node_ids_;
+    std::sort(ans->dense_node_ids_.begin(), ans->dense_node_ids_.end());
+    for(int i = 0; i < (int)ans->dense_node_ids_.size(); ++i){
+        if(ans->node_set_[ans->dense_node_ids_[i]]->position_ != i){
+            ans->get_own_node(ans->dense_node_ids_[i])->position_ = i;
+        }
+    }
+    ans->weight_of_nodes_ = weight_of_nodes_;
+    ans->weight_of_edges_ = weight_of_edges_;
+    ans->layout_ = layout_;
+    ans->incidence_ = incidence_;
+    ans->bytes_of_index_ = ans->get_bytes_of_index();
+    MemoryTracker::Charge(ans->arena_->get_category(), ans->bytes_of_index_);
+    return ans;
+}
+
+/*
+ * The subgraph induced by the nodes of node_set, the same as a copy that
+ * loses every other node, but only the kept nodes and edges are copied.
+ */
+template<class W>
+Hypergraph<W>* Hypergraph<W>::GenerateSubgraph(const set& node_set) const{
+    Hypergraph* ans = new Hypergraph("copy");
+    ans->node_set_ = node_set_;
+    ans->edge_set_ = edge_set_;
+    for(const auto& x:edge_set_){
+        ans->avl_edge_id = x.first + 1;
+    }
+    for(auto x = ans->node_set_.begin(); x != ans->node_set_.end();){
+        x = node_set.count(x->first) ? std::next(x) : ans->node_set_.erase(x);
+    }
+    for(auto x = ans->edge_set_.begin(); x != ans->edge_set_.end();){
+        bool is_inside = true;
+        for(const auto& node_id:x->second->nodes_){
+            if(!ans->node_set_.count(node_id)){
+                is_inside = false;
+                break;
+            }
+        }
+        x = is_inside ? std::next(x) : ans->edge_set_.erase(x);
+    }
+    CopyObjects(ans->node_set_, ans->arena_, layout_ == nullptr ? nullptr : &layout_->node_ids);
+    CopyObjects(ans->edge_set_, ans->arena_, layout_ == nullptr ? nullptr : &layout_->edge_ids);
+    for(const auto& x:ans->node_set_){
+        vector<int> edge_ids(x.second->edges_.begin(), x.second->edges_.end());
+        for(const auto& edge_id:edge_ids){
+            if(!ans->edge_set_.count(edge_id)){
+                x.second->Cut(*edge_set_.find(edge_id)->second);
+            }
+        }
+        ans->weight_of_nodes_ += x.second->get_weight();
+        ans->dense_node_ids_.push_back(x.first);
+    }
+    for(const auto& x:ans->edge_set_){
+        ans->weight_of_edges_ += x.second->get_weight();
+    }
+    ans->number_of_nodes_ = ans->node_set_.size();
+    ans->number_of_edges_ = ans->edge_set_.size();
+    std::sort(ans->dense_node_ids_.begin(), ans->dense_node_ids_.end());
+    for(int i = 0; i < (int)ans->dense_node_ids_.size(); ++i){
+        ans->node_set_[ans->dense_node_ids_[i]]->position_ = i;
+    }
+    ans->layout_ = layout_;
+    ans->incidence_ = incidence_;
+    ans->bytes_of_index_ = ans->get_bytes_of_index();
+    MemoryTracker::Charge(ans->arena_->get_category(), ans->bytes_of_index_);
+    return ans;
+}
+
+/*
+ * Builds the compressed incidence of the graph as it is now. Copies share
+ * it, and keep it while they only lose nodes with their edges.
+ */
+template<class W>
+void Hypergraph<W>::Compress(){
+    incidence_ = std::make_shared<const CompressedIncidence<W> >(*this);
+}
+
+/*
+ * The compressed incidence of a graph this one is the subgraph induced by
+ * some of its nodes, or nullptr if there is none or fewer than a quarter
+ * of its nodes are left; a node or an edge absent from this graph is to be
+ * skipped.
+ */
+template<class W>
+const CompressedIncidence<W>* Hypergraph<W>::get_incidence() const{
+    return incidence_ != nullptr && number_of_nodes_ * 4LL >= incidence_->get_number_of_nodes() ? incidence_.get() : nullptr;
+}
+
+template<class W>
+string Hypergraph<W>::Show() const{
     string ans = "hypergraph{\n";
     for(const auto& x:node_set_){
         ans += x.second->Show() + "\n";
@@ -449,7 +1219,28 @@ string Hypergraph::Show() const{
     return ans + "}";
 }
 
-string Hypergraph::NodeSetToFile() const{
+/*
+ * Writes Show() and the trailer as one line. Under a memory limit the
+ * graph is streamed node by node instead of being built as one string.
+ */
+template<class W>
+void Hypergraph<W>::Print(Output& output, const string trailer) const{
+    if(!MemoryTracker::is_limited()){
+        output.PrintLine(Show() + trailer);
+        return;
+    }
+    output.Print("hypergraph{\n");
+    for(const auto& x:node_set_){
+        output.Print(x.second->Show() + "\n");
+    }
+    for(const auto& x:edge_set_){
+        output.Print(x.second->Show() + "\n");
+    }
+    output.PrintLine("}" + trailer);
+}
+
+template<class W>
+string Hypergraph<W>::NodeSetToFile() const{
     string ans = "";
     for(const auto& x:node_set_){
         ans += x.second->ToFile() + "\n";
@@ -457,7 +1248,8 @@ string Hypergraph::NodeSetToFile() const{
     return ans;
 }
 
-string Hypergraph::EdgeSetToFile() const{
+template<class W>
+string Hypergraph<W>::EdgeSetToFile() const{
     string ans = "";
     for(const auto& x:edge_set_){
         ans += x.second->ToFile() + "\n";
@@ -465,61 +1257,172 @@ string Hypergraph::EdgeSetToFile() const{
     return ans;
 }
 
-string Hypergraph::get_unweighted_degree_distribution() const{
-    vector<int> vi;
+template<class W>
+void Hypergraph<W>::get_normal_graph(std::vector<set>& graph) const{
+    CsrGraph clique_expansion = get_clique_expansion();
+    graph.assign(clique_expansion.get_number_of_vertices(), set());
+    for(int v = 0; v < clique_expansion.get_number_of_vertices(); ++v){
+        graph[v].insert(clique_expansion.get_neighbors_begin(v), clique_expansion.get_neighbors_end(v));
+    }
+}
+
+/*
+ * Clique expansion over dense vertex indices in node id order. Edges with
+ * more than max_edge_size pins (if positive) are left out, since they alone
+ * contribute |e|^2 arcs. Vertices are split into chunks, and each chunk
+ * gathers the pins of the incident edges of its vertices and deduplicates
+ * them by sorting, so no shared structure is written concurrently.
+ */
+template<class W>
+CsrGraph Hypergraph<W>::get_clique_expansion(const int max_edge_size, const int number_of_threads) const{
+    vector<int> vertex_ids;
+    vertex_ids.reserve(node_set_.size());
     for(const auto& x:node_set_){
-        vi.push_back(x.second->get_unweighted_degree());
+        vertex_ids.push_back(x.first);
+    }
+    std::sort(vertex_ids.begin(), vertex_ids.end());
+    int n = vertex_ids.size();
+    HashMap<int, int> vertex;
+    vertex.reserve(n);
+    for(int v = 0; v < n; ++v){
+        vertex[vertex_ids[v]] = v;
     }
 
-    Map<int, int> cnt;
-    for(auto x:vi){
-        if(cnt.count(x)==0) cnt[x]=0;
-        cnt[x]++;
+    vector<int64_t> pin_offsets(1, 0);
+    vector<int> pins;
+    vector<int64_t> incidence_offsets(n + 1, 0);
+    for(const auto& x:edge_set_){
+        const ArenaSet& nodes = x.second->nodes_;
+        if(max_edge_size > 0 && (int)nodes.size() > max_edge_size){
+            continue;
+        }
+        for(const auto& node_id:nodes){
+            int v = vertex[node_id];
+            pins.push_back(v);
+            ++incidence_offsets[v + 1];
+        }
+        pin_offsets.push_back(pins.size());
     }
-    
-    string ans="";
-    for(auto x:cnt){
-        ans += "(" + Int2String(x.first) + " x " + Int2String(x.second) + ") ";
+    for(int v = 0; v < n; ++v){
+        incidence_offsets[v + 1] += incidence_offsets[v];
+    }
+    vector<int> incidence(pins.size());
+    vector<int64_t> position(incidence_offsets.begin(), incidence_offsets.end() - 1);
+    for(int e = 0; e + 1 < (int)pin_offsets.size(); ++e){
+        for(int64_t i = pin_offsets[e]; i < pin_offsets[e + 1]; ++i){
+            incidence[position[pins[i]]++] = e;
+        }
     }
-    return ans;
-}
 
-void Hypergraph::get_normal_graph(std::vector<set>& graph) const{
-    Map<int, int> index_of_nodes;
-    int idx = 0;
-    graph.clear();
-    for(const auto& e: edge_set_){
-        const set& node_set = e.second->nodes_;
-        std::vector<int> nodes;
-        for(int x:node_set){
-            if(index_of_nodes.count(x) == 0){
-                index_of_nodes[x] = idx++;
-                graph.push_back({});
+    int number_of_chunks = std::max(1, std::min(n, 8 * std::max(number_of_threads, 1)));
+    vector<int> chunk_begin(number_of_chunks + 1);
+    for(int c = 0; c <= number_of_chunks; ++c){
+        chunk_begin[c] = (int64_t)n * c / number_of_chunks;
+    }
+    vector<int64_t> offsets(n + 1, 0);
+    vector<vector<int> > targets_of_chunk(number_of_chunks);
+    TaskGroup group;
+    for(int c = 0; c < number_of_chunks; ++c){
+        group.Run([&, c](){
+            vector<int> neighbors;
+            for(int v = chunk_begin[c]; v < chunk_begin[c + 1]; ++v){
+                neighbors.clear();
+                for(int64_t i = incidence_offsets[v]; i < incidence_offsets[v + 1]; ++i){
+                    int e = incidence[i];
+                    for(int64_t j = pin_offsets[e]; j < pin_offsets[e + 1]; ++j){
+                        if(pins[j] != v){
+                            neighbors.push_back(pins[j]);
+                        }
+                    }
+                }
+                std::sort(neighbors.begin(), neighbors.end());
+                neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+                offsets[v + 1] = neighbors.size();
+                targets_of_chunk[c].insert(targets_of_chunk[c].end(), neighbors.begin(), neighbors.end());
             }
-            nodes.push_back(x);
+        });
+    }
+    group.Wait();
+    for(int v = 0; v < n; ++v){
+        offsets[v + 1] += offsets[v];
+    }
+    vector<int> targets(offsets[n]);
+    for(int c = 0; c < number_of_chunks; ++c){
+        group.Run([&, c](){
+            std::copy(targets_of_chunk[c].begin(), targets_of_chunk[c].end(), targets.begin() + offsets[chunk_begin[c]]);
+            vector<int>().swap(targets_of_chunk[c]);
+        });
+    }
+    group.Wait();
+    return CsrGraph(std::move(offsets), std::move(targets), std::move(vertex_ids));
+}
+
+/*
+ * Bipartite star expansion, linear in the number of pins: vertices
+ * [0, n) are the nodes in id order and [n, n+m) the edges in id order.
+ */
+template<class W>
+CsrGraph Hypergraph<W>::get_star_expansion() const{
+    vector<int> vertex_ids;
+    vertex_ids.reserve(node_set_.size() + edge_set_.size());
+    for(const auto& x:node_set_){
+        vertex_ids.push_back(x.first);
+    }
+    int n = vertex_ids.size();
+    for(const auto& x:edge_set_){
+        vertex_ids.push_back(x.first);
+    }
+    std::sort(vertex_ids.begin(), vertex_ids.begin() + n);
+    std::sort(vertex_ids.begin() + n, vertex_ids.end());
+    int number_of_vertices = vertex_ids.size();
+    HashMap<int, int> vertex;
+    vertex.reserve(n);
+    for(int v = 0; v < n; ++v){
+        vertex[vertex_ids[v]] = v;
+    }
+
+    vector<int64_t> offsets(number_of_vertices + 1, 0);
+    for(int v = n; v < number_of_vertices; ++v){
+        const ArenaSet& nodes = edge_set_.find(vertex_ids[v])->second->nodes_;
+        offsets[v + 1] = nodes.size();
+        for(const auto& node_id:nodes){
+            ++offsets[vertex[node_id] + 1];
         }
-        for(int i = nodes.size() - 1; i >= 0; --i){
-            for(int j = i - 1; j >= 0; --j){
-                graph[index_of_nodes[nodes[i]]].insert(index_of_nodes[nodes[j]]);
-                graph[index_of_nodes[nodes[j]]].insert(index_of_nodes[nodes[i]]);
-            }
+    }
+    for(int v = 0; v < number_of_vertices; ++v){
+        offsets[v + 1] += offsets[v];
+    }
+    vector<int> targets(offsets[number_of_vertices]);
+    vector<int64_t> position(offsets.begin(), offsets.end() - 1);
+    for(int v = n; v < number_of_vertices; ++v){
+        for(const auto& node_id:edge_set_.find(vertex_ids[v])->second->nodes_){
+            int u = vertex[node_id];
+            targets[position[u]++] = v;
+            targets[position[v]++] = u;
         }
     }
+    for(int v = n; v < number_of_vertices; ++v){
+        std::sort(targets.begin() + offsets[v], targets.begin() + offsets[v + 1]);
+    }
+    return CsrGraph(std::move(offsets), std::move(targets), std::move(vertex_ids));
 }
 
 /**********HypergraphWithHeap**********/
 
-void HypergraphWithHeap::EraseNode(const int node_id){
-    Hypergraph::EraseNode(node_id);
+template<class W>
+void HypergraphWithHeap<W>::EraseNode(const int node_id){
+    Hypergraph<W>::EraseNode(node_id);
     heap_.erase(node_id);
 }
 
-void HypergraphWithHeap::EraseEdge(const int edge_id){
+template<class W>
+void HypergraphWithHeap<W>::EraseEdge(const int edge_id){
     #ifndef NVAL
     if(!has_edge(edge_id)){
         return;
     }
     #endif
+    incidence_.reset();
     auto e = edge_set_[edge_id];
     for(const auto& node_id:e->nodes_){
         node_set_[node_id]->Cut(*e);
@@ -528,27 +1431,33 @@ void HypergraphWithHeap::EraseEdge(const int edge_id){
     weight_of_edges_ -= e->get_weight();
     edge_set_.erase(edge_id);
     --number_of_edges_;
-    delete e;
 }
 
-HypergraphWithHeap::HypergraphWithHeap(const Hypergraph& graph):Hypergraph(graph){
+template<class W>
+HypergraphWithHeap<W>::HypergraphWithHeap(const Hypergraph<W>& graph):HypergraphWithHeap(graph, nullptr){}
+
+template<class W>
+HypergraphWithHeap<W>::HypergraphWithHeap(const Hypergraph<W>& graph, Arena* arena):Hypergraph<W>(graph, arena), heap_charge_("heap", 64LL * graph.get_number_of_nodes()){
     for(const auto& x:node_set_){
         heap_.push(x.first, x.second->get_degree());
     }
 }
 
-int HypergraphWithHeap::Top(){
+template<class W>
+int HypergraphWithHeap<W>::Top(){
     return heap_.top();
 }
 
-void HypergraphWithHeap::Pop(){
+template<class W>
+void HypergraphWithHeap<W>::Pop(){
     int node_id = heap_.top();
     EraseNode(node_id);
 }
 
 /**********HypergraphWithPruningEdge**********/
 
-void HypergraphWithPruningEdge::EraseNode(const int node_id){
+template<class W>
+void HypergraphWithPruningEdge<W>::EraseNode(const int node_id){
     #ifdef DEBUG
     LOG("");
     #endif
@@ -559,7 +1468,7 @@ void HypergraphWithPruningEdge::EraseNode(const int node_id){
     }
     #endif
     auto u = node_set_[node_id];
-    set edge_set_to_be_deleted = u->edges_;
+    vector<int> edge_set_to_be_deleted(u->edges_.begin(), u->edges_.end());
     for(const auto& edge_id:edge_set_to_be_deleted){
         #ifndef NVAL
         if(!has_edge(edge_id) || !edge_set_[edge_id]->has_node(node_id)){
@@ -572,9 +1481,150 @@ void HypergraphWithPruningEdge::EraseNode(const int node_id){
         }
     }
     weight_of_nodes_ -= u->get_weight();
-    node_set_.erase(node_id);
+    DetachNode(node_id);
     --number_of_nodes_;
-    delete u;
 }
 
-HypergraphWithPruningEdge::HypergraphWithPruningEdge(const Hypergraph& g):Hypergraph(g){}
+template<class W>
+HypergraphWithPruningEdge<W>::HypergraphWithPruningEdge(const Hypergraph<W>& g):Hypergraph<W>(g){}
+
+/**********DynamicHypergraph**********/
+
+template<class W>
+DynamicHypergraph<W>::DynamicHypergraph(Input node_input, Input edge_input): Hypergraph<W>(node_input, edge_input), next_edge_id_(0), number_of_erasures_(0){
+    for(const auto& x:edge_set_){
+        next_edge_id_ = std::max(next_edge_id_, x.first + 1);
+    }
+}
+
+template<class W>
+DynamicHypergraph<W>::DynamicHypergraph(const DynamicHypergraph& graph): Hypergraph<W>(graph), next_edge_id_(graph.next_edge_id_), number_of_erasures_(0){}
+
+template<class W>
+bool DynamicHypergraph<W>::InsertNode(const int node_id, const Weight<W> node_weight){
+    if(this->has_node(node_id)){
+        return false;
+    }
+    this->AddNode(node_id, node_weight);
+    return true;
+}
+
+/*
+ * Returns the id of the new edge, or -1 if it has no pins or a pin is not
+ * in the graph. Repeated pins are counted once.
+ */
+template<class W>
+int DynamicHypergraph<W>::InsertEdge(const vector<int>& nodes, const Weight<W> edge_weight){
+    vector<int> pins(nodes);
+    std::sort(pins.begin(), pins.end());
+    pins.erase(std::unique(pins.begin(), pins.end()), pins.end());
+    if(pins.empty()){
+        return -1;
+    }
+    for(const auto& node_id:pins){
+        if(!this->has_node(node_id)){
+            return -1;
+        }
+    }
+    this->AddEdge(pins, edge_weight, next_edge_id_);
+    return next_edge_id_++;
+}
+
+template<class W>
+bool DynamicHypergraph<W>::DeleteNode(const int node_id){
+    if(!this->has_node(node_id)){
+        return false;
+    }
+    number_of_erasures_ += 1 + node_set_[node_id]->edges_.size();
+    this->EraseNode(node_id);
+    return true;
+}
+
+template<class W>
+bool DynamicHypergraph<W>::DeleteEdge(const int edge_id){
+    if(!this->has_edge(edge_id)){
+        return false;
+    }
+    ++number_of_erasures_;
+    this->EraseEdge(edge_id);
+    return true;
+}
+
+template<class W>
+Weight<W> DynamicHypergraph<W>::get_weight_of_node(const int node_id) const{
+    return node_set_.find(node_id)->second->get_weight();
+}
+
+template<class W>
+Weight<W> DynamicHypergraph<W>::get_weight_of_edge(const int edge_id) const{
+    return edge_set_.find(edge_id)->second->get_weight();
+}
+
+template<class W>
+vector<int> DynamicHypergraph<W>::get_nodes_of_edge(const int edge_id) const{
+    return edge_set_.find(edge_id)->second->get_nodes_id();
+}
+
+template<class W>
+vector<int> DynamicHypergraph<W>::get_edges_of_node(const int node_id) const{
+    const auto& edges = node_set_.find(node_id)->second->edges_;
+    return vector<int>(edges.begin(), edges.end());
+}
+
+template<class W>
+vector<int> DynamicHypergraph<W>::get_edge_ids() const{
+    vector<int> ans;
+    ans.reserve(edge_set_.size());
+    for(const auto& x:edge_set_){
+        ans.push_back(x.first);
+    }
+    return ans;
+}
+
+template<class W>
+int DynamicHypergraph<W>::get_number_of_erasures() const{
+    return number_of_erasures_;
+}
+
+/*
+ * Returns the narrowest weight type that represents the input exactly:
+ * unweighted when every weight is 1, int64 when every weight token is read
+ * whole as an int64, as the int64 build reads it, and double otherwise.
+ * Lines are read as Node::Read and Edge::Read do.
+ */
+string DetectWeightType(Input node_input, Input edge_input){
+    bool is_unweighted = true, is_integral = true;
+    std::stringstream ss;
+    int node_id;
+    string pins, token;
+    auto check = [&](){
+        int64_t integer;
+        double value;
+        is_integral = is_integral && String2Value(token, integer);
+        is_unweighted = is_unweighted && String2Value(token, value) && value == 1;
+        return is_integral || is_unweighted;
+    };
+    while(node_input.NextLine(ss) && ss >> node_id >> token){
+        if(!check()){
+            return "double";
+        }
+    }
+    while(edge_input.NextLine(ss) && ss >> pins >> token){
+        if(!check()){
+            return "double";
+        }
+    }
+    return is_unweighted ? "unweighted" : is_integral ? "int64" : "double";
+}
+
+#define INSTANTIATE_HYPERGRAPH(W) \
+template struct DensityBounds<W>; \
+template class CompressedIncidence<W>; \
+template class Node<W>; \
+template class Edge<W>; \
+template class Hypergraph<W>; \
+template class HypergraphWithHeap<W>; \
+template class HypergraphWithPruningEdge<W>; \
+template class DynamicHypergraph<W>;
+
+FOR_EACH_WEIGHT_TYPE(INSTANTIATE_HYPERGRAPH)
@@ -13,37 +13,119 @@
 #include "utility.h"
 #include "data_structure.h"
 
-class node;
-class Edge;
-class Hypergraph;
-class HypergraphWithHeap;
+#include <memory>
+
+template<class W> class Node;
+template<class W> class Edge;
+template<class W> class Hypergraph;
+template<class W> class HypergraphWithHeap;
+template<class W> class HypergraphWithPruningEdge;
+template<class W> class DynamicHypergraph;
+template<class W> class SemiExternalHypergraph;
+template<class W> class TwinContraction;
+
+/**********Layout**********/
+
+/*
+ * Allocation order of a reordered graph: the ids of its nodes and of its
+ * edges in the order their objects are laid out in memory. Ids are never
+ * renamed, so every tie is broken as without the layout. A graph and all
+ * its copies share one.
+ */
+struct Layout{
+vector<int> node_ids;
+vector<int> edge_ids;
+};
+
+/**********DensityBounds**********/
+
+/*
+ * What is known of the optimal density before an exact solve: the node set
+ * of a subgraph reaching lower (e.g. the greedy one, possibly empty) and an
+ * upper bound (e.g. the largest degree at removal while peeling), negative
+ * when unknown. When the two agree within kEps the lower set is densest.
+ */
+template<class W>
+struct DensityBounds{
+Density<W> lower = 0;
+Density<W> upper = -1;
+vector<int> lower_node_set;
+bool has_upper() const;
+bool is_tight() const;
+};
+
+/**********CompressedIncidence**********/
+
+/*
+ * Read-only copy of the incidence of a hypergraph: nodes and edges are
+ * numbered densely in order of id, and the pins of every edge and the
+ * edges of every node are delta and varint coded lists of those numbers.
+ * Hypergraph::Compress() builds it. The graph and its copies keep it while
+ * they only lose nodes, so they stay induced subgraphs of it, and drop it
+ * on any other change; the peeling and the model builders walk it, skipping
+ * what the graph lost, instead of the hash sets of the graph.
+ */
+template<class W>
+class CompressedIncidence{
+private:
+vector<int> node_ids_;
+vector<int> edge_ids_;
+vector<Weight<W> > node_weights_;
+vector<Weight<W> > edge_weights_;
+CompressedPinLists pins_;
+CompressedPinLists edges_;
+MemoryCharge* charge_;
+
+public:
+CompressedIncidence(const Hypergraph<W>&);
+CompressedIncidence(const CompressedIncidence&) = delete;
+~CompressedIncidence();
+int get_number_of_nodes() const;
+int get_number_of_edges() const;
+int64_t get_number_of_pins() const;
+int get_node_id(const int) const;
+int get_edge_id(const int) const;
+Weight<W> get_weight_of_node(const int) const;
+Weight<W> get_weight_of_edge(const int) const;
+CompressedPinLists::List get_pins(const int) const;
+CompressedPinLists::List get_edges(const int) const;
+int64_t get_bytes_of_lists() const;
+int64_t get_bytes_of_plain_lists() const;
+double MeasureDecoding() const;
+};
 
 /**********Node**********/
 
+template<class W>
 class Node{
 
-friend class Hypergraph;
-friend class HypergraphWithHeap;
-friend class HypergraphWithPruningEdge;
+friend class Hypergraph<W>;
+friend class HypergraphWithHeap<W>;
+friend class HypergraphWithPruningEdge<W>;
+friend class DynamicHypergraph<W>;
+friend class CompressedIncidence<W>;
 
 private:
 int id_;
-ld weight_;
-ld weight_of_edges_;
-set edges_;
+int position_;
+Weight<W> weight_;
+Weight<W> weight_of_edges_;
+ArenaSet edges_;
 
 public:
-static bool Read(Input&, int&, ld&);
-Node(const int);
+static bool Read(Input&, int&, Weight<W>&);
+Node(const int, Arena*);
+Node(const Node&, Arena*);
 int get_id() const;
-ld get_weight() const;
-void set_weight(const ld);
+Weight<W> get_weight() const;
+Weight<W> get_weight_of_edges() const;
+void set_weight(const Weight<W>);
 bool has_edge(const int) const;
-void Connect(const int, const ld);
-void Connect(const Edge&);
-void Cut(const int, const ld);
-void Cut(const Edge&);
-ld get_degree() const;
+void Connect(const int, const Weight<W>);
+void Connect(const Edge<W>&);
+void Cut(const int, const Weight<W>);
+void Cut(const Edge<W>&);
+Density<W> get_degree() const;
 string Show() const;
 string ToFile() const;
 int get_unweighted_degree() const;
@@ -55,28 +137,111 @@ friend class RemoveSmallComponent;
 
 /**********Edge**********/
 
+template<class W>
 class Edge{
 
-friend class Hypergraph;
-friend class HypergraphWithHeap;
-friend class HypergraphWithPruningEdge;
+friend class Hypergraph<W>;
+friend class HypergraphWithHeap<W>;
+friend class HypergraphWithPruningEdge<W>;
+friend class DynamicHypergraph<W>;
+friend class CompressedIncidence<W>;
 
 private:
 int id_;
-ld weight_;
-set nodes_;
+Weight<W> weight_;
+ArenaSet nodes_;
 
 public:
-static bool Read(Input&, ld&, vector<int>&);
-Edge(const int);
+static bool Read(Input&, Weight<W>&, vector<int>&);
+Edge(const int, Arena*);
+Edge(const Edge&, Arena*);
 int get_id() const;
-ld get_weight() const;
-void set_weight(const ld);
+Weight<W> get_weight() const;
+void set_weight(const Weight<W>);
 bool has_node(const int) const;
 void Connect(const int);
-void Connect(const Node&);
+void Connect(const Node<W>&);
 void Cut(const int);
-void Cut(const Node&);
+void Cut(const Node<W>&);
+string Show() const;
+string ToFile() const;
+vector<int> get_nodes_id() const;
+
+friend class GurobiHypergraphMethod;
+friend class RemoveSmallComponent;
+
+};
+
+/**********Node<Unweighted>**********/
+
+/*
+ * Unweighted nodes and edges keep no weights: every weight is 1 and the
+ * degree of a node is its number of incident edges.
+ */
+template<>
+class Node<Unweighted>{
+
+friend class Hypergraph<Unweighted>;
+friend class HypergraphWithHeap<Unweighted>;
+friend class HypergraphWithPruningEdge<Unweighted>;
+friend class DynamicHypergraph<Unweighted>;
+friend class CompressedIncidence<Unweighted>;
+
+private:
+int id_;
+int position_;
+ArenaSet edges_;
+
+public:
+static bool Read(Input&, int&, Weight<Unweighted>&);
+Node(const int, Arena*);
+Node(const Node&, Arena*);
+int get_id() const;
+Weight<Unweighted> get_weight() const;
+Weight<Unweighted> get_weight_of_edges() const;
+void set_weight(const Weight<Unweighted>);
+bool has_edge(const int) const;
+void Connect(const int, const Weight<Unweighted>);
+void Connect(const Edge<Unweighted>&);
+void Cut(const int, const Weight<Unweighted>);
+void Cut(const Edge<Unweighted>&);
+Density<Unweighted> get_degree() const;
+string Show() const;
+string ToFile() const;
+int get_unweighted_degree() const;
+
+friend class GurobiHypergraphMethod;
+friend class RemoveSmallComponent;
+
+};
+
+/**********Edge<Unweighted>**********/
+
+template<>
+class Edge<Unweighted>{
+
+friend class Hypergraph<Unweighted>;
+friend class HypergraphWithHeap<Unweighted>;
+friend class HypergraphWithPruningEdge<Unweighted>;
+friend class DynamicHypergraph<Unweighted>;
+friend class CompressedIncidence<Unweighted>;
+
+private:
+int id_;
+ArenaSet nodes_;
+
+public:
+static bool Read(Input&, Weight<Unweighted>&, vector<int>&);
+Edge(const int, Arena*);
+Edge(const Edge&, Arena*);
+int get_id() const;
+Weight<Unweighted> get_weight() const;
+void set_weight(const Weight<Unweighted>);
+bool has_node(const int) const;
+void Connect(const int);
+void Connect(const Node<Unweighted>&);
+void Cut(const int);
+void Cut(const Node<Unweighted>&);
 string Show() const;
 string ToFile() const;
 vector<int> get_nodes_id() const;
@@ -88,73 +253,161 @@ friend class RemoveSmallComponent;
 
 /**********Hypergraph**********/
 
+/*
+ * Nodes, edges and their adjacency sets live in the arena of the graph and
+ * are freed together with it; erasing a node or an edge only unlinks it.
+ * A residual graph starts out with the objects of its source and copies a
+ * node into its own arena before changing it; edges are only changed in
+ * place by HypergraphWithPruningEdge, which is always a full copy.
+ */
+template<class W>
 class Hypergraph{
 protected:
+Arena* arena_;
+bool owns_arena_;
 int number_of_nodes_, number_of_edges_;
 int avl_edge_id;
-HashMap<int, Node*> node_set_;
-HashMap<int, Edge*> edge_set_;
-ld weight_of_nodes_, weight_of_edges_;
+HashMap<int, Node<W>*> node_set_;
+HashMap<int, Edge<W>*> edge_set_;
+Weight<W> weight_of_nodes_, weight_of_edges_;
+vector<int> dense_node_ids_;
+std::shared_ptr<const Layout> layout_;
+std::shared_ptr<const CompressedIncidence<W> > incidence_;
+bool shares_objects_;
+set own_nodes_;
+long long bytes_of_index_;
+Hypergraph();
+Hypergraph(const char*);
+Hypergraph(const Hypergraph&, Arena*, const std::shared_ptr<const Layout>);
 void Clear();
-Node* AddNode(const int, const ld);
-Edge* AddEdge(const vector<int>&, const ld, const int);
+Node<W>* get_own_node(const int);
+void DetachNode(const int);
+long long get_bytes_of_index() const;
+Node<W>* AddNode(const int, const Weight<W>);
+Edge<W>* AddEdge(const vector<int>&, const Weight<W>, const int);
 int get_assigned_edge_id();
 virtual void EraseNode(const int);
 virtual void EraseEdge(const int);
 
 public:
-Hypergraph(Input, Input);
+Hypergraph(Input, Input, const bool = false);
 Hypergraph(const Hypergraph&);
+Hypergraph(const Hypergraph&, Arena*);
 ~Hypergraph();
 bool is_empty() const;
 bool has_node(const int) const;
 bool has_edge(const int) const;
 int get_number_of_nodes() const;
 int get_number_of_edges() const;
-ld get_degree_of_node(const int);
-ld get_weight_of_nodes() const;
-ld get_density() const;
+Density<W> get_degree_of_node(const int);
+Weight<W> get_weight_of_nodes() const;
+Weight<W> get_weight_of_edges() const;
+Density<W> get_density() const;
 set get_node_set() const;
+void GetNodeWeights(vector<int>&, vector<Weight<W> >&, vector<Weight<W> >&) const;
+void GetEdges(vector<vector<int> >&, vector<Weight<W> >&) const;
+void GetEdges(CompressedPinLists&, vector<Weight<W> >&) const;
 int get_random_node_id() const;
 void RemoveNodeSet(const set);
 static Hypergraph* GenerateComplement(const Hypergraph&, const Hypergraph&);
 static Hypergraph* GenerateInducement(const Hypergraph&, const Hypergraph&);
+Hypergraph* GenerateReordering(const string) const;
+Hypergraph* GenerateResidual() const;
+Hypergraph* GenerateSubgraph(const set&) const;
+void Compress();
+const CompressedIncidence<W>* get_incidence() const;
 string Show() const;
+void Print(Output&, const string) const;
 string NodeSetToFile() const;
 string EdgeSetToFile() const;
-string get_unweighted_degree_distribution() const;
 void get_normal_graph(std::vector<set>&) const;
+CsrGraph get_clique_expansion(const int = 0, const int = 1) const;
+CsrGraph get_star_expansion() const;
 
 friend class GurobiHypergraphMethod;
 friend class RemoveSmallComponent;
+friend class SemiExternalHypergraph<W>;
+friend class TwinContraction<W>;
+friend class CompressedIncidence<W>;
 
 };
 
 /**********HypergraphWithHeap**********/
 
-class HypergraphWithHeap: public Hypergraph{
+template<class W>
+class HypergraphWithHeap: public Hypergraph<W>{
 protected:
-Heap heap_;
+using Hypergraph<W>::number_of_edges_;
+using Hypergraph<W>::node_set_;
+using Hypergraph<W>::edge_set_;
+using Hypergraph<W>::weight_of_edges_;
+using Hypergraph<W>::incidence_;
+using Hypergraph<W>::has_edge;
+typename PeelingQueue<W>::Type heap_;
+MemoryCharge heap_charge_;
 void EraseNode(const int) override;
 void EraseEdge(const int) override;
 
 public:
-HypergraphWithHeap(const Hypergraph&);
+HypergraphWithHeap(const Hypergraph<W>&);
+HypergraphWithHeap(const Hypergraph<W>&, Arena*);
 int Top();
 void Pop();
 };
 
 /**********HypergraphWithPruningEdge**********/
 
-class HypergraphWithPruningEdge: public Hypergraph{
+template<class W>
+class HypergraphWithPruningEdge: public Hypergraph<W>{
 protected:
+using Hypergraph<W>::number_of_nodes_;
+using Hypergraph<W>::node_set_;
+using Hypergraph<W>::edge_set_;
+using Hypergraph<W>::weight_of_nodes_;
+using Hypergraph<W>::has_node;
+using Hypergraph<W>::has_edge;
+using Hypergraph<W>::EraseEdge;
+using Hypergraph<W>::DetachNode;
 void EraseNode(const int) override;
 
 public:
-HypergraphWithPruningEdge(const Hypergraph&);
+HypergraphWithPruningEdge(const Hypergraph<W>&);
+
+};
+
+/**********DynamicHypergraph**********/
+
+/*
+ * A hypergraph updated in place by a stream of insertions and deletions.
+ * Edge ids are never reused, so an id handed out stays valid for later
+ * updates. Erased objects keep their arena memory until the graph is copied.
+ */
+template<class W>
+class DynamicHypergraph: public Hypergraph<W>{
+protected:
+using Hypergraph<W>::node_set_;
+using Hypergraph<W>::edge_set_;
+int next_edge_id_;
+int number_of_erasures_;
+
+public:
+DynamicHypergraph(Input, Input);
+DynamicHypergraph(const DynamicHypergraph&);
+bool InsertNode(const int, const Weight<W>);
+int InsertEdge(const vector<int>&, const Weight<W>);
+bool DeleteNode(const int);
+bool DeleteEdge(const int);
+Weight<W> get_weight_of_node(const int) const;
+Weight<W> get_weight_of_edge(const int) const;
+vector<int> get_nodes_of_edge(const int) const;
+vector<int> get_edges_of_node(const int) const;
+vector<int> get_edge_ids() const;
+int get_number_of_erasures() const;
 
 };
 
+string DetectWeightType(Input, Input);
+
 // #include "hypergraph.cc"
 
 #endif // __HYPERGRAPH__
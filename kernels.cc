@@ -0,0 +1,260 @@
+/*
+ *
+ * For paper 'Finding Subgraphs with Maximum Total Density and Limited Overlap in Weighted Hypergraphs'
+ *
+ * Copyright reserved.
+ *
+ */
+
+#include "kernels.h"
+
+#include <cmath>
+#include <immintrin.h>
+
+/**********Scalar**********/
+
+template<class T>
+void Kernels::Scalar::BatchDegree(const T* weights_of_edges, const T* weights, const int n, Density<T>* degrees){
+    for(int i = 0; i < n; ++i){
+        if(cmp(weights[i], 0) == 0){
+            degrees[i] = 0;
+        }else{
+            degrees[i] = (Density<T>)weights_of_edges[i] / weights[i];
+        }
+    }
+}
+
+template<class T>
+int Kernels::Scalar::FilterBelow(const T* values, const int n, const T threshold, int* indices){
+    int cnt = 0;
+    for(int i = 0; i < n; ++i){
+        if(values[i] < threshold){
+            indices[cnt++] = i;
+        }
+    }
+    return cnt;
+}
+
+template<class T>
+T Kernels::Scalar::MaxValue(const T* values, const int n){
+    if(n == 0){
+        return 0;
+    }
+    T ans = values[0];
+    for(int i = 1; i < n; ++i){
+        if(values[i] > ans){
+            ans = values[i];
+        }
+    }
+    return ans;
+}
+
+/**********Avx2**********/
+
+namespace{
+
+__attribute__((target("avx2")))
+void BatchDegreeAvx2(const double* weights_of_edges, const double* weights, const int n, double* degrees){
+    const __m256d eps = _mm256_set1_pd(kEps);
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    int i = 0;
+    for(; i + 4 <= n; i += 4){
+        __m256d w = _mm256_loadu_pd(weights + i);
+        __m256d d = _mm256_div_pd(_mm256_loadu_pd(weights_of_edges + i), w);
+        __m256d is_zero = _mm256_cmp_pd(_mm256_andnot_pd(sign, w), eps, _CMP_LT_OQ);
+        _mm256_storeu_pd(degrees + i, _mm256_andnot_pd(is_zero, d));
+    }
+    Kernels::Scalar::BatchDegree(weights_of_edges + i, weights + i, n - i, degrees + i);
+}
+
+__attribute__((target("avx2")))
+int FilterBelowAvx2(const double* values, const int n, const double threshold, int* indices){
+    const __m256d t = _mm256_set1_pd(threshold);
+    int cnt = 0;
+    int i = 0;
+    for(; i + 4 <= n; i += 4){
+        int mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(values + i), t, _CMP_LT_OQ));
+        while(mask){
+            indices[cnt++] = i + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+    for(; i < n; ++i){
+        if(values[i] < threshold){
+            indices[cnt++] = i;
+        }
+    }
+    return cnt;
+}
+
+__attribute__((target("avx2")))
+double MaxValueAvx2(const double* values, const int n){
+    if(n < 4){
+        return Kernels::Scalar::MaxValue(values, n);
+    }
+    __m256d m = _mm256_loadu_pd(values);
+    int i = 4;
+    for(; i + 4 <= n; i += 4){
+        m = _mm256_max_pd(m, _mm256_loadu_pd(values + i));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, m);
+    double ans = Kernels::Scalar::MaxValue(lanes, 4);
+    for(; i < n; ++i){
+        if(values[i] > ans){
+            ans = values[i];
+        }
+    }
+    return ans;
+}
+
+/**********Avx512**********/
+
+__attribute__((target("avx512f")))
+void BatchDegreeAvx512(const double* weights_of_edges, const double* weights, const int n, double* degrees){
+    const __m512d eps = _mm512_set1_pd(kEps);
+    int i = 0;
+    for(; i + 8 <= n; i += 8){
+        __m512d w = _mm512_loadu_pd(weights + i);
+        __mmask8 is_nonzero = _mm512_cmp_pd_mask(_mm512_abs_pd(w), eps, _CMP_GE_OQ);
+        __m512d d = _mm512_maskz_div_pd(is_nonzero, _mm512_loadu_pd(weights_of_edges + i), w);
+        _mm512_storeu_pd(degrees + i, d);
+    }
+    Kernels::Scalar::BatchDegree(weights_of_edges + i, weights + i, n - i, degrees + i);
+}
+
+__attribute__((target("avx512f")))
+int FilterBelowAvx512(const double* values, const int n, const double threshold, int* indices){
+    const __m512d t = _mm512_set1_pd(threshold);
+    int cnt = 0;
+    int i = 0;
+    for(; i + 8 <= n; i += 8){
+        unsigned int mask = _mm512_cmp_pd_mask(_mm512_loadu_pd(values + i), t, _CMP_LT_OQ);
+        while(mask){
+            indices[cnt++] = i + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+    for(; i < n; ++i){
+        if(values[i] < threshold){
+            indices[cnt++] = i;
+        }
+    }
+    return cnt;
+}
+
+__attribute__((target("avx512f")))
+double MaxValueAvx512(const double* values, const int n){
+    if(n < 8){
+        return Kernels::Scalar::MaxValue(values, n);
+    }
+    __m512d m = _mm512_loadu_pd(values);
+    int i = 8;
+    for(; i + 8 <= n; i += 8){
+        m = _mm512_max_pd(m, _mm512_loadu_pd(values + i));
+    }
+    double ans = _mm512_reduce_max_pd(m);
+    for(; i < n; ++i){
+        if(values[i] > ans){
+            ans = values[i];
+        }
+    }
+    return ans;
+}
+
+int DetectSimdLevel(){
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f")){
+        return Kernels::kAvx512;
+    }
+    if(__builtin_cpu_supports("avx2")){
+        return Kernels::kAvx2;
+    }
+    return Kernels::kScalar;
+}
+
+const int simd_level = DetectSimdLevel();
+
+}
+
+/**********Dispatch**********/
+
+int Kernels::get_simd_level(){
+    return simd_level;
+}
+
+string Kernels::get_simd_name(){
+    if(simd_level == kAvx512){
+        return "avx512";
+    }
+    if(simd_level == kAvx2){
+        return "avx2";
+    }
+    return "scalar";
+}
+
+template<class T>
+void Kernels::BatchDegree(const T* weights_of_edges, const T* weights, const int n, Density<T>* degrees){
+    Scalar::BatchDegree(weights_of_edges, weights, n, degrees);
+}
+
+template<class T>
+int Kernels::FilterBelow(const T* values, const int n, const T threshold, int* indices){
+    return Scalar::FilterBelow(values, n, threshold, indices);
+}
+
+template<class T>
+T Kernels::MaxValue(const T* values, const int n){
+    return Scalar::MaxValue(values, n);
+}
+
+namespace Kernels{
+
+template<>
+void BatchDegree<double>(const double* weights_of_edges, const double* weights, const int n, double* degrees){
+    if(simd_level == kAvx512){
+        BatchDegreeAvx512(weights_of_edges, weights, n, degrees);
+    }else if(simd_level == kAvx2){
+        BatchDegreeAvx2(weights_of_edges, weights, n, degrees);
+    }else{
+        Scalar::BatchDegree(weights_of_edges, weights, n, degrees);
+    }
+}
+
+template<>
+int FilterBelow<double>(const double* values, const int n, const double threshold, int* indices){
+    if(simd_level == kAvx512){
+        return FilterBelowAvx512(values, n, threshold, indices);
+    }else if(simd_level == kAvx2){
+        return FilterBelowAvx2(values, n, threshold, indices);
+    }
+    return Scalar::FilterBelow(values, n, threshold, indices);
+}
+
+template<>
+double MaxValue<double>(const double* values, const int n){
+    if(simd_level == kAvx512){
+        return MaxValueAvx512(values, n);
+    }else if(simd_level == kAvx2){
+        return MaxValueAvx2(values, n);
+    }
+    return Scalar::MaxValue(values, n);
+}
+
+}
+
+#define INSTANTIATE_KERNELS(T) \
+template void Kernels::Scalar::BatchDegree(const T*, const T*, const int, Density<T>*); \
+template int Kernels::Scalar::FilterBelow(const T*, const int, const T, int*); \
+template T Kernels::Scalar::MaxValue(const T*, const int);
+
+#define INSTANTIATE_GENERIC_KERNELS(T) \
+template void Kernels::BatchDegree(const T*, const T*, const int, Density<T>*); \
+template int Kernels::FilterBelow(const T*, const int, const T, int*); \
+template T Kernels::MaxValue(const T*, const int);
+
+INSTANTIATE_KERNELS(double)
+INSTANTIATE_KERNELS(long double)
+INSTANTIATE_KERNELS(int64_t)
+INSTANTIATE_GENERIC_KERNELS(long double)
+INSTANTIATE_GENERIC_KERNELS(int64_t)
@@ -0,0 +1,54 @@
+/*
+ *
+ * For paper 'Finding Subgraphs with Maximum Total Density and Limited Overlap in Weighted Hypergraphs'
+ *
+ * Copyright reserved.
+ *
+ */
+
+#ifndef __KERNELS__
+#define __KERNELS__
+
+#include "macro.h"
+
+/*
+ * Kernels over contiguous weight arrays. The generic versions are scalar;
+ * the double versions pick AVX-512, AVX2 or scalar code once at runtime.
+ */
+
+namespace Kernels{
+
+const int kScalar = 0;
+const int kAvx2 = 1;
+const int kAvx512 = 2;
+
+int get_simd_level();
+string get_simd_name();
+
+namespace Scalar{
+    template<class T>
+    void BatchDegree(const T*, const T*, const int, Density<T>*);
+    template<class T>
+    int FilterBelow(const T*, const int, const T, int*);
+    template<class T>
+    T MaxValue(const T*, const int);
+}
+
+template<class T>
+void BatchDegree(const T*, const T*, const int, Density<T>*);
+
+template<class T>
+int FilterBelow(const T*, const int, const T, int*);
+
+template<class T>
+T MaxValue(const T*, const int);
+
+template<> void BatchDegree<double>(const double*, const double*, const int, double*);
+template<> int FilterBelow<double>(const double*, const int, const double, int*);
+template<> double MaxValue<double>(const double*, const int);
+
+}
+
+// #include "kernels.cc"
+
+#endif // __KERNELS__
@@ -11,39 +11,28 @@
 
 #include "hypergraph.h"
 
-#include "gurobi_c++.h"
-
-
-/**********GurobiHypergraphMethod**********/
-
-class GurobiHypergraphMethod{
-public:
-static int GenerateNodeVariable(const Hypergraph*, GRBModel&, HashMap<int, GRBVar>&);
-static int GenerateEdgeVariable(const Hypergraph*, GRBModel&, HashMap<int, GRBVar>&);
-static int AddEdgeNodeConstraints(const Hypergraph*, HashMap<int, GRBVar>&, HashMap<int, GRBVar>&, GRBModel&);
-static void GetNodeWeightedSumExpression(const Hypergraph*, HashMap<int, GRBVar>&, GRBLinExpr&);
-static void GetEdgeWeightedSumExpression(const Hypergraph*, HashMap<int, GRBVar>&, GRBLinExpr&);
-
-};
+#include "lp_solver.h"
 
 /**********LpAlgorithm**********/
 
+template<class W>
 class LpAlgorithm{
 public:
-virtual void FastLp(HashMap<int, GRBVar>&, Hypergraph*);
-virtual void FastLpForModified(HashMap<int, GRBVar>&, Hypergraph*);
-Hypergraph* BasicLp(const Hypergraph*, const bool);
-Hypergraph* ModifiedLp(const Hypergraph*, const int, const ld, const bool);
+virtual void FastLp(const LpSolver<W>&, Hypergraph<W>*);
+virtual void FastLpForModified(const LpSolver<W>&, Hypergraph<W>*);
+Hypergraph<W>* BasicLp(const Hypergraph<W>*, const bool, const TimeBudget& = TimeBudget(), const DensityBounds<W>& = DensityBounds<W>());
+Hypergraph<W>* ModifiedLp(const Hypergraph<W>*, const int, const Density<W>, const bool, const TimeBudget& = TimeBudget());
 };
 
 /**********LpWithUniquenessCheck**********/
 
 namespace UniquenessAlgorithm{
-class LpWithUniquenessCheck: public LpAlgorithm{
+template<class W>
+class LpWithUniquenessCheck: public LpAlgorithm<W>{
 public:
-void FastLp(HashMap<int, GRBVar>&, Hypergraph*) override;
-bool BasicLp(const Hypergraph*, const bool, Hypergraph*&);
-bool ModifiedLp(const Hypergraph*, const int, const ld, const bool, Hypergraph*&);
+void FastLp(const LpSolver<W>&, Hypergraph<W>*) override;
+bool BasicLp(const Hypergraph<W>*, const bool, Hypergraph<W>*&);
+bool ModifiedLp(const Hypergraph<W>*, const int, const Density<W>, const bool, Hypergraph<W>*&);
 };
 }
 
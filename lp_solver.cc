@@ -0,0 +1,576 @@
+/*
+ *
+ * For paper 'Finding Subgraphs with Maximum Total Density and Limited Overlap in Weighted Hypergraphs'
+ *
+ * Copyright reserved.
+ *
+ */
+
+#include "lp_solver.h"
+#include "hypergraph.h"
+#include "utility.h"
+
+#include <algorithm>
+
+/**********LpSolver**********/
+
+/* One backend for every weight type, chosen once at startup. */
+#ifdef WITHOUTGUROBI
+static string lp_backend = "flow";
+#else
+static string lp_backend = "gurobi";
+#endif // WITHOUTGUROBI
+
+template<class W>
+void LpSolver<W>::set_backend(const string backend){
+    #ifdef WITHOUTGUROBI
+    if(backend == "gurobi"){
+        Console::Error("This build has no Gurobi backend; rebuild with GUROBI=1 or use --lp-solver=flow.");
+    }
+    #endif // WITHOUTGUROBI
+    if(backend != "gurobi" && backend != "flow"){
+        Console::Error("Unknown LP solver <" + backend + ">.");
+    }
+    lp_backend = backend;
+}
+
+template<class W>
+string LpSolver<W>::get_backend(){
+    return lp_backend;
+}
+
+template<class W>
+LpSolver<W>* LpSolver<W>::Create(){
+    #ifndef WITHOUTGUROBI
+    if(lp_backend == "gurobi"){
+        return new GurobiLpSolver<W>();
+    }
+    #endif // WITHOUTGUROBI
+    return new FlowLpSolver<W>();
+}
+
+template<class W>
+LpSolver<W>::~LpSolver(){}
+
+/**********FlowLpSolver**********/
+
+template<class W>
+FlowLpSolver<W>::FlowLpSolver(): network_(nullptr), has_lower_bound_(false), lower_bound_(0), target_node_(-1), start_density_(0), upper_bound_(-1), density_(0), objective_value_(0), value_(0){}
+
+template<class W>
+FlowLpSolver<W>::~FlowLpSolver(){
+    delete network_;
+}
+
+template<class W>
+string FlowLpSolver<W>::get_name() const{
+    return "flow";
+}
+
+template<class W>
+void FlowLpSolver<W>::Build(const Hypergraph<W>* g){
+    delete network_;
+    network_ = new ClosureNetwork<W>(g);
+    start_density_ = 0;
+    upper_bound_ = -1;
+}
+
+template<class W>
+long long FlowLpSolver<W>::get_bytes() const{
+    return network_ == nullptr ? 0 : network_->get_bytes();
+}
+
+template<class W>
+void FlowLpSolver<W>::SetTimeLimit(const double seconds){
+    budget_ = TimeBudget(seconds);
+}
+
+template<class W>
+void FlowLpSolver<W>::SetEdgeWeightLowerBound(const Density<W> bound){
+    has_lower_bound_ = true;
+    lower_bound_ = bound;
+}
+
+template<class W>
+void FlowLpSolver<W>::MaximizeEdgeWeight(){
+    target_node_ = -1;
+}
+
+template<class W>
+void FlowLpSolver<W>::MaximizeNode(const int node_id){
+    target_node_ = node_id;
+}
+
+template<class W>
+void FlowLpSolver<W>::SetWarmStart(const vector<int>& node_ids){
+    start_density_ = std::max(start_density_, network_->get_density(node_ids));
+}
+
+template<class W>
+void FlowLpSolver<W>::SetDensityBounds(const DensityBounds<W>& bounds){
+    start_density_ = std::max(start_density_, bounds.lower);
+    if(bounds.has_upper()){
+        upper_bound_ = bounds.upper;
+    }
+}
+
+/*
+ * The density found is optimal, so the edge sum bound holds iff it does
+ * not exceed it. The support of the solution is a densest set for the edge
+ * objective, and the smallest densest set holding the target node (or the
+ * maximal one if no densest set holds it) for a node objective.
+ */
+template<class W>
+typename LpSolver<W>::Status FlowLpSolver<W>::Optimize(){
+    density_ = start_density_;
+    if(!network_->Maximize(density_, budget_, upper_bound_, target_node_ >= 0)){
+        return LpSolver<W>::kTimeLimit;
+    }
+    if(has_lower_bound_ && cmp(density_, lower_bound_) < 0){
+        return LpSolver<W>::kInfeasible;
+    }
+    support_ = target_node_ < 0 ? vector<int>() : network_->get_closure(target_node_);
+    bool is_target_held = !support_.empty();
+    if(!is_target_held){
+        support_ = target_node_ < 0 ? network_->get_densest_node_set() : network_->get_maximal_node_set();
+    }
+    Weight<W> weight_of_support = network_->get_weight_of_nodes(support_);
+    value_ = cmp(weight_of_support, 0) > 0 ? 1.0 / (double)weight_of_support : 0;
+    if(target_node_ < 0){
+        objective_value_ = (double)density_;
+    }else{
+        objective_value_ = is_target_held ? value_ : 0;
+    }
+    return LpSolver<W>::kOptimal;
+}
+
+template<class W>
+double FlowLpSolver<W>::get_objective_value() const{
+    return objective_value_;
+}
+
+template<class W>
+double FlowLpSolver<W>::get_node_dual() const{
+    return (double)density_;
+}
+
+template<class W>
+void FlowLpSolver<W>::GetNodeValues(vector<int>& node_ids, vector<double>& values) const{
+    node_ids = network_->get_node_ids();
+    values.assign(node_ids.size(), 0);
+    set members(support_.begin(), support_.end());
+    for(int i = 0; i < (int)node_ids.size(); ++i){
+        if(members.count(node_ids[i])){
+            values[i] = value_;
+        }
+    }
+}
+
+#ifndef WITHOUTGUROBI
+
+/**********GurobiHypergraphMethod**********/
+
+/* The model builders read the compressed incidence of g when it has one, skipping what g lacks. */
+template<class W>
+int GurobiHypergraphMethod::GenerateNodeVariable(const Hypergraph<W>* g, GRBModel& model, HashMap<int, GRBVar>& node_variable){
+    int cnt = 0;
+    const CompressedIncidence<W>* incidence = g->get_incidence();
+    if(incidence != nullptr){
+        for(int i = 0; i < incidence->get_number_of_nodes(); ++i){
+            int node_id = incidence->get_node_id(i);
+            if(!g->has_node(node_id)){
+                continue;
+            }
+            node_variable[node_id] = model.addVar(0.0, 1.0, 0.0, GRB_CONTINUOUS, string("y" + Int2String(node_id)));    ++cnt;
+        }
+        return cnt;
+    }
+    for(const auto& x:g->node_set_){
+        node_variable[x.first] = model.addVar(0.0, 1.0, 0.0, GRB_CONTINUOUS, string("y" + Int2String(x.first)));    ++cnt;
+    }
+    return cnt;
+}
+
+template<class W>
+int GurobiHypergraphMethod::GenerateEdgeVariable(const Hypergraph<W>* g, GRBModel& model, HashMap<int, GRBVar>& edge_variable){
+    int cnt = 0;
+    const CompressedIncidence<W>* incidence = g->get_incidence();
+    if(incidence != nullptr){
+        for(int j = 0; j < incidence->get_number_of_edges(); ++j){
+            int edge_id = incidence->get_edge_id(j);
+            if(!g->has_edge(edge_id)){
+                continue;
+            }
+            edge_variable[edge_id] = model.addVar(0.0, 1.0, 0.0, GRB_CONTINUOUS, "x" + Int2String(edge_id));    ++cnt;
+        }
+        return cnt;
+    }
+    for(const auto& x:g->edge_set_){
+        edge_variable[x.first] = model.addVar(0.0, 1.0, 0.0, GRB_CONTINUOUS, "x" + Int2String(x.first));    ++cnt;
+    }
+    return cnt;
+}
+
+template<class W>
+int GurobiHypergraphMethod::AddEdgeNodeConstraints(const Hypergraph<W>* g, HashMap<int, GRBVar>& node_variable, HashMap<int, GRBVar>& edge_variable, GRBModel& model){
+    int cnt = 0;
+    const CompressedIncidence<W>* incidence = g->get_incidence();
+    if(incidence != nullptr){
+        for(int j = 0; j < incidence->get_number_of_edges(); ++j){
+            int edge_id = incidence->get_edge_id(j);
+            if(!g->has_edge(edge_id)){
+                continue;
+            }
+            for(const auto& i:incidence->get_pins(j)){
+                int node_id = incidence->get_node_id(i);
+                model.addConstr(edge_variable[edge_id] - node_variable[node_id] <= 0, "x" + Int2String(edge_id) + " <= y" + Int2String(node_id));   ++cnt;
+            }
+        }
+        return cnt;
+    }
+    for(const auto& x:g->edge_set_){
+        int edge_id = x.first;
+        Edge<W>* e = x.second;
+        for(const auto& node_id:e->nodes_){
+            model.addConstr(edge_variable[edge_id] - node_variable[node_id] <= 0, "x" + Int2String(edge_id) + " <= y" + Int2String(node_id));   ++cnt;
+        }
+    }
+    return cnt;
+}
+
+template<class W>
+void GurobiHypergraphMethod::GetNodeWeightedSumExpression(const Hypergraph<W>* g, HashMap<int, GRBVar>& node_variable, GRBLinExpr& node_weighted_sum){
+    const CompressedIncidence<W>* incidence = g->get_incidence();
+    if(incidence != nullptr){
+        for(int i = 0; i < incidence->get_number_of_nodes(); ++i){
+            if(g->has_node(incidence->get_node_id(i))){
+                node_weighted_sum += (double)incidence->get_weight_of_node(i) * node_variable[incidence->get_node_id(i)];
+            }
+        }
+        return;
+    }
+    for(const auto& x:g->node_set_){
+        node_weighted_sum += (double)x.second->get_weight() * node_variable[x.first];
+    }
+}
+
+template<class W>
+void GurobiHypergraphMethod::GetEdgeWeightedSumExpression(const Hypergraph<W>* g, HashMap<int, GRBVar>& edge_variable, GRBLinExpr& edge_weighted_sum){
+    const CompressedIncidence<W>* incidence = g->get_incidence();
+    if(incidence != nullptr){
+        for(int j = 0; j < incidence->get_number_of_edges(); ++j){
+            if(g->has_edge(incidence->get_edge_id(j))){
+                edge_weighted_sum += (double)incidence->get_weight_of_edge(j) * edge_variable[incidence->get_edge_id(j)];
+            }
+        }
+        return;
+    }
+    for(const auto& x:g->edge_set_){
+        edge_weighted_sum += (double)x.second->get_weight() * edge_variable[x.first];
+    }
+}
+
+void GurobiHypergraphMethod::GetNodeValues(const HashMap<int, GRBVar>& node_variable, vector<int>& node_ids, vector<double>& values){
+    node_ids.clear();
+    values.clear();
+    for(const auto& x:node_variable){
+        node_ids.push_back(x.first);
+        values.push_back(x.second.get(GRB_DoubleAttr_X));
+    }
+}
+
+/*
+ * Starts y_v and x_e at 1 / w(S) for the nodes of S and the edges inside
+ * it, and every other variable at 0.
+ */
+template<class W>
+void GurobiHypergraphMethod::SetStart(const Hypergraph<W>* g, const vector<int>& node_ids, HashMap<int, GRBVar>& node_variable, HashMap<int, GRBVar>& edge_variable){
+    set members;
+    Weight<W> weight_of_nodes = 0;
+    for(const auto& node_id:node_ids){
+        auto x = g->node_set_.find(node_id);
+        if(x != g->node_set_.end() && members.insert(node_id).second){
+            weight_of_nodes += x->second->get_weight();
+        }
+    }
+    double value = cmp(weight_of_nodes, 0) > 0 ? 1.0 / (double)weight_of_nodes : 0;
+    for(const auto& x:g->node_set_){
+        node_variable[x.first].set(GRB_DoubleAttr_Start, members.count(x.first) ? value : 0.0);
+    }
+    for(const auto& x:g->edge_set_){
+        bool is_inside = true;
+        for(const auto& node_id:x.second->nodes_){
+            if(!members.count(node_id)){
+                is_inside = false;
+                break;
+            }
+        }
+        edge_variable[x.first].set(GRB_DoubleAttr_Start, is_inside ? value : 0.0);
+    }
+}
+
+/*
+ * Density of the subgraph of g induced by the nodes node_ids.
+ */
+template<class W>
+double GurobiHypergraphMethod::GetDensity(const Hypergraph<W>* g, const vector<int>& node_ids){
+    set members(node_ids.begin(), node_ids.end());
+    Weight<W> weight_of_nodes = 0, weight_of_edges = 0;
+    for(const auto& node_id:members){
+        weight_of_nodes += g->node_set_.at(node_id)->get_weight();
+    }
+    for(const auto& x:g->edge_set_){
+        bool is_inside = true;
+        for(const auto& node_id:x.second->nodes_){
+            if(!members.count(node_id)){
+                is_inside = false;
+                break;
+            }
+        }
+        if(is_inside){
+            weight_of_edges += x.second->get_weight();
+        }
+    }
+    return cmp(weight_of_nodes, 0) > 0 ? (double)weight_of_edges / (double)weight_of_nodes : 0;
+}
+
+/*
+ * Rough size of a Gurobi model: a few dozen bytes of attributes per row
+ * and column, and each nonzero stored by row and by column.
+ */
+long long EstimateModelBytes(const long long number_of_variables, const long long number_of_constraints, const long long number_of_nonzeros){
+    return 96 * (number_of_variables + number_of_constraints) + 24 * number_of_nonzeros;
+}
+
+/**********GurobiLpSolver**********/
+
+static void ReportGurobiError(const GRBException& e){
+    string info = "Error code = " + Int2String(e.getErrorCode()) + "\n" + e.getMessage();
+    Console::Error(info);
+}
+
+template<class W>
+GurobiLpSolver<W>::GurobiLpSolver(): graph_(nullptr), env_(nullptr), model_(nullptr), bytes_(0), status_(0), is_edge_objective_(true), objective_stop_(GRB_INFINITY){
+    try{
+        env_ = new GRBEnv(true);
+        env_->set(GRB_IntParam_OutputFlag, 0);
+        env_->set(GRB_IntParam_Method, 1);
+        env_->start();
+    }catch(GRBException e){
+        ReportGurobiError(e);
+    }
+}
+
+template<class W>
+GurobiLpSolver<W>::~GurobiLpSolver(){
+    delete model_;
+    delete env_;
+}
+
+template<class W>
+string GurobiLpSolver<W>::get_name() const{
+    return "gurobi";
+}
+
+template<class W>
+void GurobiLpSolver<W>::Build(const Hypergraph<W>* g){
+    try{
+        graph_ = g;
+        delete model_;
+        model_ = new GRBModel(*env_);
+        node_variable_.clear();
+        edge_variable_.clear();
+        int number_of_nodes = GurobiHypergraphMethod::GenerateNodeVariable(g, *model_, node_variable_);
+        int number_of_edges = GurobiHypergraphMethod::GenerateEdgeVariable(g, *model_, edge_variable_);
+        GRBLinExpr node_weighted_sum;
+        edge_weighted_sum_ = GRBLinExpr();
+        GurobiHypergraphMethod::GetNodeWeightedSumExpression(g, node_variable_, node_weighted_sum);
+        GurobiHypergraphMethod::GetEdgeWeightedSumExpression(g, edge_variable_, edge_weighted_sum_);
+        int number_of_node_edge_pairs = GurobiHypergraphMethod::AddEdgeNodeConstraints(g, node_variable_, edge_variable_, *model_);
+        node_constraint_ = model_->addConstr(node_weighted_sum <= 1.0, "nodeconstraints");
+        model_->setObjective(edge_weighted_sum_, GRB_MAXIMIZE);
+        is_edge_objective_ = true;
+        objective_stop_ = GRB_INFINITY;
+        bytes_ = EstimateModelBytes(number_of_nodes + number_of_edges, number_of_node_edge_pairs + 2, 2 * number_of_node_edge_pairs + number_of_nodes + number_of_edges);
+    }catch(GRBException e){
+        ReportGurobiError(e);
+    }
+}
+
+template<class W>
+long long GurobiLpSolver<W>::get_bytes() const{
+    return bytes_;
+}
+
+template<class W>
+void GurobiLpSolver<W>::SetTimeLimit(const double seconds){
+    try{
+        model_->set(GRB_DoubleParam_TimeLimit, seconds);
+    }catch(GRBException e){
+        ReportGurobiError(e);
+    }
+}
+
+template<class W>
+void GurobiLpSolver<W>::SetEdgeWeightLowerBound(const Density<W> bound){
+    try{
+        model_->addConstr(edge_weighted_sum_ >= (double)bound, "edgeconstraints");
+    }catch(GRBException e){
+        ReportGurobiError(e);
+    }
+}
+
+template<class W>
+void GurobiLpSolver<W>::MaximizeEdgeWeight(){
+    try{
+        is_edge_objective_ = true;
+        model_->setObjective(edge_weighted_sum_, GRB_MAXIMIZE);
+        model_->set(GRB_DoubleParam_BestObjStop, objective_stop_);
+    }catch(GRBException e){
+        ReportGurobiError(e);
+    }
+}
+
+template<class W>
+void GurobiLpSolver<W>::MaximizeNode(const int node_id){
+    try{
+        is_edge_objective_ = false;
+        GRBLinExpr objective_expression;
+        objective_expression += 1.0 * node_variable_[node_id];
+        model_->setObjective(objective_expression, GRB_MAXIMIZE);
+        model_->set(GRB_DoubleParam_BestObjStop, GRB_INFINITY);
+    }catch(GRBException e){
+        ReportGurobiError(e);
+    }
+}
+
+template<class W>
+void GurobiLpSolver<W>::SetWarmStart(const vector<int>& node_ids){
+    try{
+        GurobiHypergraphMethod::SetStart(graph_, node_ids, node_variable_, edge_variable_);
+    }catch(GRBException e){
+        ReportGurobiError(e);
+    }
+}
+
+template<class W>
+void GurobiLpSolver<W>::SetDensityBounds(const DensityBounds<W>& bounds){
+    try{
+        if(bounds.has_upper()){
+            objective_stop_ = (double)bounds.upper - kEps;
+            if(is_edge_objective_){
+                model_->set(GRB_DoubleParam_BestObjStop, objective_stop_);
+            }
+        }
+        if(!bounds.lower_node_set.empty()){
+            SetWarmStart(bounds.lower_node_set);
+        }
+    }catch(GRBException e){
+        ReportGurobiError(e);
+    }
+}
+
+/*
+ * A stop at the objective limit settles the optimal value, but the point
+ * reached is only feasible. The callers read the top level set of its
+ * node values, so the point is kept when that set is itself dense enough
+ * to meet the upper bound, as a warm start from a set close to it is.
+ * Otherwise the solve goes on from the stopped basis without the limit,
+ * which is then set again for the next solve.
+ */
+template<class W>
+typename LpSolver<W>::Status GurobiLpSolver<W>::Optimize(){
+    try{
+        model_->optimize();
+        status_ = model_->get(GRB_IntAttr_Status);
+        if(status_ == GRB_USER_OBJ_LIMIT && !is_certified()){
+            model_->set(GRB_DoubleParam_BestObjStop, GRB_INFINITY);
+            model_->optimize();
+            status_ = model_->get(GRB_IntAttr_Status);
+            model_->set(GRB_DoubleParam_BestObjStop, objective_stop_);
+        }
+    }catch(GRBException e){
+        ReportGurobiError(e);
+    }
+    if(status_ == GRB_TIME_LIMIT){
+        return LpSolver<W>::kTimeLimit;
+    }
+    if(status_ == GRB_INF_OR_UNBD || status_ == GRB_INFEASIBLE || status_ == GRB_UNBOUNDED){
+        return LpSolver<W>::kInfeasible;
+    }
+    if(status_ != GRB_OPTIMAL && status_ != GRB_USER_OBJ_LIMIT){
+        Console::Error("Gurobi stopped with status " + Int2String(status_) + ".");
+    }
+    return LpSolver<W>::kOptimal;
+}
+
+/*
+ * Whether the top level set of the current node values, the set FastLp
+ * keeps, has a density of at least the objective limit.
+ */
+template<class W>
+bool GurobiLpSolver<W>::is_certified() const{
+    vector<int> node_ids, support;
+    vector<double> values;
+    GurobiHypergraphMethod::GetNodeValues(node_variable_, node_ids, values);
+    if(values.empty()){
+        return false;
+    }
+    double max_value = *std::max_element(values.begin(), values.end());
+    for(int i = 0; i < (int)values.size(); ++i){
+        if(values[i] >= max_value - kEps){
+            support.push_back(node_ids[i]);
+        }
+    }
+    return GurobiHypergraphMethod::GetDensity(graph_, support) >= objective_stop_;
+}
+
+template<class W>
+double GurobiLpSolver<W>::get_objective_value() const{
+    double ans = 0;
+    try{
+        ans = model_->get(GRB_DoubleAttr_ObjVal);
+    }catch(GRBException e){
+        ReportGurobiError(e);
+    }
+    return ans;
+}
+
+template<class W>
+double GurobiLpSolver<W>::get_node_dual() const{
+    /* A kept stop has no dual, but its objective is within kEps of the optimum. */
+    if(status_ == GRB_USER_OBJ_LIMIT){
+        return get_objective_value();
+    }
+    double ans = 0;
+    try{
+        ans = node_constraint_.get(GRB_DoubleAttr_Pi);
+    }catch(GRBException e){
+        ReportGurobiError(e);
+    }
+    return ans;
+}
+
+template<class W>
+void GurobiLpSolver<W>::GetNodeValues(vector<int>& node_ids, vector<double>& values) const{
+    try{
+        GurobiHypergraphMethod::GetNodeValues(node_variable_, node_ids, values);
+    }catch(GRBException e){
+        ReportGurobiError(e);
+    }
+}
+
+#endif // WITHOUTGUROBI
+
+#ifdef WITHOUTGUROBI
+#define INSTANTIATE_LP_SOLVER(W) \
+template class LpSolver<W>; \
+template class FlowLpSolver<W>;
+#else
+#define INSTANTIATE_LP_SOLVER(W) \
+template class LpSolver<W>; \
+template class FlowLpSolver<W>; \
+template class GurobiLpSolver<W>;
+#endif // WITHOUTGUROBI
+
+FOR_EACH_WEIGHT_TYPE(INSTANTIATE_LP_SOLVER)
@@ -0,0 +1,160 @@
+/*
+ *
+ * For paper 'Finding Subgraphs with Maximum Total Density and Limited Overlap in Weighted Hypergraphs'
+ *
+ * Copyright reserved.
+ *
+ */
+
+#ifndef __LP_SOLVER__
+#define __LP_SOLVER__
+
+#include "hypergraph.h"
+#include "flow.h"
+
+#ifndef WITHOUTGUROBI
+#include "gurobi_c++.h"
+#endif // WITHOUTGUROBI
+
+/**********LpSolver**********/
+
+/*
+ * A backend for the densest subgraph LP of a hypergraph: maximize the
+ * weighted sum of x_e subject to x_e <= y_v for every pin v of e and
+ * sum of w(v) y_v <= 1, with every variable in [0, 1]. The objective can be
+ * swapped for a single y_u, a lower bound on the edge sum can be added, and
+ * a node set S seeds the solve with y = 1_S / w(S). Known bounds on the
+ * optimal density let a backend stop once the optimum is settled. The dual
+ * of the node constraint is the optimal density when the edge sum is
+ * maximized.
+ */
+template<class W>
+class LpSolver{
+public:
+enum Status{kOptimal, kInfeasible, kTimeLimit};
+static void set_backend(const string);
+static string get_backend();
+static LpSolver* Create();
+virtual ~LpSolver();
+virtual string get_name() const = 0;
+virtual void Build(const Hypergraph<W>*) = 0;
+virtual long long get_bytes() const = 0;
+virtual void SetTimeLimit(const double) = 0;
+virtual void SetEdgeWeightLowerBound(const Density<W>) = 0;
+virtual void MaximizeEdgeWeight() = 0;
+virtual void MaximizeNode(const int) = 0;
+virtual void SetWarmStart(const vector<int>&) = 0;
+virtual void SetDensityBounds(const DensityBounds<W>&) = 0;
+virtual Status Optimize() = 0;
+virtual double get_objective_value() const = 0;
+virtual double get_node_dual() const = 0;
+virtual void GetNodeValues(vector<int>&, vector<double>&) const = 0;
+};
+
+/**********FlowLpSolver**********/
+
+/*
+ * Solves the LP combinatorially on the closure network. Its optimal face is
+ * spanned by the points 1_S / w(S) of the densest node sets S, so the edge
+ * objective is met by the maximal densest set and y_u by the smallest
+ * densest set holding u. A warm start and the lower bound seed the
+ * density search, and the upper bound lets it bisect and stop early.
+ */
+template<class W>
+class FlowLpSolver: public LpSolver<W>{
+private:
+ClosureNetwork<W>* network_;
+TimeBudget budget_;
+bool has_lower_bound_;
+Density<W> lower_bound_;
+int target_node_;
+Density<W> start_density_;
+Density<W> upper_bound_;
+Density<W> density_;
+vector<int> support_;
+double objective_value_;
+double value_;
+
+public:
+FlowLpSolver();
+~FlowLpSolver();
+string get_name() const override;
+void Build(const Hypergraph<W>*) override;
+long long get_bytes() const override;
+void SetTimeLimit(const double) override;
+void SetEdgeWeightLowerBound(const Density<W>) override;
+void MaximizeEdgeWeight() override;
+void MaximizeNode(const int) override;
+void SetWarmStart(const vector<int>&) override;
+void SetDensityBounds(const DensityBounds<W>&) override;
+typename LpSolver<W>::Status Optimize() override;
+double get_objective_value() const override;
+double get_node_dual() const override;
+void GetNodeValues(vector<int>&, vector<double>&) const override;
+};
+
+#ifndef WITHOUTGUROBI
+
+/**********GurobiHypergraphMethod**********/
+
+class GurobiHypergraphMethod{
+public:
+template<class W> static int GenerateNodeVariable(const Hypergraph<W>*, GRBModel&, HashMap<int, GRBVar>&);
+template<class W> static int GenerateEdgeVariable(const Hypergraph<W>*, GRBModel&, HashMap<int, GRBVar>&);
+template<class W> static int AddEdgeNodeConstraints(const Hypergraph<W>*, HashMap<int, GRBVar>&, HashMap<int, GRBVar>&, GRBModel&);
+template<class W> static void GetNodeWeightedSumExpression(const Hypergraph<W>*, HashMap<int, GRBVar>&, GRBLinExpr&);
+template<class W> static void GetEdgeWeightedSumExpression(const Hypergraph<W>*, HashMap<int, GRBVar>&, GRBLinExpr&);
+template<class W> static void SetStart(const Hypergraph<W>*, const vector<int>&, HashMap<int, GRBVar>&, HashMap<int, GRBVar>&);
+template<class W> static double GetDensity(const Hypergraph<W>*, const vector<int>&);
+static void GetNodeValues(const HashMap<int, GRBVar>&, vector<int>&, vector<double>&);
+
+};
+
+/**********GurobiLpSolver**********/
+
+/*
+ * The LP as a Gurobi model, solved by the primal simplex. The upper bound
+ * on the density is an objective limit; a solve stopped there is kept when
+ * the top level set of its node values is dense enough to meet the bound,
+ * and finished without the limit otherwise. Gurobi errors end the run
+ * through Console::Error.
+ */
+template<class W>
+class GurobiLpSolver: public LpSolver<W>{
+private:
+const Hypergraph<W>* graph_;
+GRBEnv* env_;
+GRBModel* model_;
+HashMap<int, GRBVar> node_variable_;
+HashMap<int, GRBVar> edge_variable_;
+GRBLinExpr edge_weighted_sum_;
+GRBConstr node_constraint_;
+long long bytes_;
+int status_;
+bool is_edge_objective_;
+double objective_stop_;
+bool is_certified() const;
+
+public:
+GurobiLpSolver();
+~GurobiLpSolver();
+string get_name() const override;
+void Build(const Hypergraph<W>*) override;
+long long get_bytes() const override;
+void SetTimeLimit(const double) override;
+void SetEdgeWeightLowerBound(const Density<W>) override;
+void MaximizeEdgeWeight() override;
+void MaximizeNode(const int) override;
+void SetWarmStart(const vector<int>&) override;
+void SetDensityBounds(const DensityBounds<W>&) override;
+typename LpSolver<W>::Status Optimize() override;
+double get_objective_value() const override;
+double get_node_dual() const override;
+void GetNodeValues(vector<int>&, vector<double>&) const override;
+};
+
+#endif // WITHOUTGUROBI
+
+// #include "lp_solver.cc"
+
+#endif // __LP_SOLVER__
@@ -10,17 +10,70 @@
 
 #include <cmath>
 
-inline int cmp(const ld a, const ld b){
-    if(fabs(a - b) < kEps)   return 0;
+template<>
+inline const char* WeightTypeName<double>(){
+    return "double";
+}
+
+template<>
+inline const char* WeightTypeName<long double>(){
+    return "long double";
+}
+
+template<>
+inline const char* WeightTypeName<int64_t>(){
+    return "int64";
+}
+
+template<>
+inline const char* WeightTypeName<Unweighted>(){
+    return "unweighted";
+}
+
+template<class T1, class T2>
+inline int cmp(const T1 a, const T2 b){
+    if(std::fabs(a - b) < kEps)   return 0;
     if(a < b) return -1;
     return 1;
 }
 
+/*
+ * The seed of --seed, set before any thread starts; the default is the
+ * default seed of std::mt19937.
+ */
+inline uint32_t& get_random_seed(){
+    static uint32_t seed = std::mt19937::default_seed;
+    return seed;
+}
+
+/*
+ * One engine per thread; its state can be saved and restored through the
+ * stream operators of std::mt19937.
+ */
+inline std::mt19937& get_random_engine(){
+    static thread_local std::mt19937 engine(get_random_seed());
+    return engine;
+}
+
+/*
+ * Restarts the engine of the calling thread for stream, e.g. a query or a
+ * job, so that its draws depend on the seed and the stream but not on the
+ * thread it runs on. Stream 0 is the seed itself.
+ */
+inline void SeedRandomEngine(const uint32_t stream){
+    if(stream == 0){
+        get_random_engine().seed(get_random_seed());
+        return;
+    }
+    std::seed_seq sequence{get_random_seed(), stream};
+    get_random_engine().seed(sequence);
+}
+
 inline int get_random_value(const int lower_bound, const int upper_bound){
     if(lower_bound == upper_bound){
         return lower_bound;
     }
-    return lower_bound + rand() % (upper_bound - lower_bound);
+    return lower_bound + get_random_engine()() % (unsigned)(upper_bound - lower_bound);
 }
 
 
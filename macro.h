@@ -13,6 +13,8 @@
 #include <vector>
 #include <unordered_set>
 #include <algorithm>
+#include <cstdint>
+#include <random>
 
 using string = std::string;
 
@@ -21,12 +23,50 @@ using vector = std::vector<T>;
 
 using set = std::unordered_set<int>;
 
-using ld = long double;
+/*
+ * Weights are stored as Weight<W>; degrees, densities and heap keys use
+ * Density<W>, which only differs from W for integral weights. Unweighted
+ * graphs store no weights at all and count incidences instead.
+ */
+struct Unweighted{};
+
+template<class W>
+struct WeightTraits{
+using Value = W;
+using Density = W;
+};
+
+template<>
+struct WeightTraits<int64_t>{
+using Value = int64_t;
+using Density = double;
+};
+
+template<>
+struct WeightTraits<Unweighted>{
+using Value = int64_t;
+using Density = double;
+};
+
+template<class W>
+using Weight = typename WeightTraits<W>::Value;
+
+template<class W>
+using Density = typename WeightTraits<W>::Density;
+
+template<class W>
+const char* WeightTypeName();
+
+#define FOR_EACH_WEIGHT_TYPE(F) F(double) F(long double) F(int64_t) F(Unweighted)
 
-const ld kEps = 1e-7;
-const ld kInf = 1e366l;
+const double kEps = 1e-7;
+const double kInf = 1e300;
 
-inline int cmp(const ld, const ld);
+template<class T1, class T2>
+inline int cmp(const T1, const T2);
+inline uint32_t& get_random_seed();
+inline std::mt19937& get_random_engine();
+inline void SeedRandomEngine(const uint32_t);
 inline int get_random_value(const int, const int);
 //template<class T1>
 //inline string count_vector(const std::vector<T1>&, bool (*)(const T1&, const T1&), string (*get_value)(const T1&)){
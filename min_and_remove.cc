@@ -9,6 +9,20 @@
 #include "utility.h"
 #include "hypergraph.h"
 #include "algorithms.h"
+#include "dynamic.h"
+#include "flow.h"
+#include "lp_solver.h"
+#include "cache.h"
+#include "stats.h"
+#include "external.h"
+
+#include <iostream>
+#include <memory>
+#include <atomic>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 string info = R"(
 The program takes 5+1 arguments:
@@ -18,92 +32,1077 @@ The program takes 5+1 arguments:
 - the number of dense subgraphs we want to extract, where the default is 10;
 - the parameter alpha which sets the threshold for the overlapping, where the default is 0.0 (no overlap) [this parameter will be ignored in Naive algorithm];
 - (will be deleted later) the way we use to remove nodes in Line 7 Algorithm 5, where 1 (default) denote the first kind, and 2 denote the second kind [this parameter will be ignored in Naive algorithm].
+
+Options:
+An option is given its value as --option=value. Options whose value is required (--weight-type, --time-budget, --dynamic, --epsilon, --threads, --batch, --summary, --max-edge-size, --memory-limit, --seed, --lp-solver) also take it from the next argument, as in --threads 4; the others never take the next argument.
+- --weight-type=<auto|double|long-double|int64|unweighted>: numeric type of weights and densities; auto (default) picks unweighted when every weight is 1, int64 when every weight is integral and double otherwise.
+- --time-budget=<seconds>: wall-clock budget for MinAndRemove(2); every round publishes the greedy subgraph first and refines it toward the minimal densest subgraph while time remains.
+- --dynamic=<updates file>: apply a stream of updates to the hypergraph while a split of every edge weight among its pins is kept balanced, which bounds the optimum and yields a (1+epsilon)-approximate densest subgraph in amortized polylogarithmic time per update; at every report the limited-overlap list of k subgraphs is rebuilt around a new densest subgraph only when the first one is no longer within 1+epsilon of the bound, and only the first one is certified; the algorithm argument is ignored and auto detects the weight type from the hypergraph files, with unweighted inputs read as int64; update weights must fit that type. Each line of the file is one of
+    +n <node id> <weight>         insert a node;
+    -n <node id>                  delete a node and its edges;
+    +e <id>,<id>,...,<id> <weight>  insert an edge, whose id is reported;
+    -e <edge id>                  delete an edge, where edges of the hypergraph file are numbered from 0 in order;
+    ?                             report the current subgraphs.
+- --epsilon=<value>: approximation slack of --dynamic and --semi-external, where the default is 0.1.
+- --serve[=<socket path>]: load the hypergraph once and answer queries from stdin, or from a Unix domain socket when a path is given, until "quit" or the end of input; only the two file arguments are taken. Each query line is "<algo> <k> <alpha> <removal way> [time budget]" and is answered by one JSON line carrying its id, the densities and the result file.
+- --threads=<n>: size of the shared thread pool, which answers the queries of --serve, runs the jobs of --batch and parallelizes --stats and --expand, where the default is the number of hardware threads.
+- --checkpoint: after every extracted subgraph, save the residual graph, the extracted subgraphs, the random engine and the output written so far to <result file>.checkpoint; runs with a time budget are not checkpointed.
+- --resume: continue from the checkpoint of an interrupted run with the same arguments, which yields the same result file apart from the elapsed time; checkpoints are kept on.
+- --batch=<manifest>: run every job of the manifest in one process instead of a single run; no positional arguments are taken. Each line of the manifest is "<nodes file> <hypergraph file> [algo] [k] [alpha] [removal way]" with the defaults above, and lines starting with # are skipped. Each dataset is loaded once and shared by its jobs, jobs run concurrently on --threads threads, every job writes its usual result file, and a table of all jobs is written to --summary=<file>, by default ./result/<manifest>_[Batch]_summary. Malformed lines, jobs whose files can't be opened and jobs whose result file an earlier line already writes are skipped and reported in the error column of the table. --time-budget and --weight-type apply to every job.
+- --uniqueness: decide whether the minimal densest subgraph is unique instead of extracting k subgraphs; only the two file arguments are taken. One exact solve by parametric max-flow yields the optimal density, the maximal densest subgraph and every minimal densest subgraph, which are written to the result file.
+- --expand=<clique|star>: write the clique expansion (one "<id> <id>" line per pair of nodes sharing an edge) or the star expansion (one "<node id> <edge id>" line per pin) of the hypergraph instead of extracting subgraphs; only the two file arguments are taken. The clique expansion is built on --threads threads and leaves out edges with more than --max-edge-size=<n> pins when n is positive.
+- --stats: print a JSON profile of the dataset to stdout instead of extracting subgraphs; only the two file arguments are taken. The files are parsed and profiled on --threads threads: node degree, edge cardinality and weight histograms, connected components, the max core number and the greedy density.
+- --semi-external[=<directory>]: run NaiveApprox(1) or ApproxMinAndRemove(3) with only per-node state in memory. The edges are converted once into a binary spill file in the directory, by default the one of the hypergraph file, and every peeling round is one sequential pass over it that removes all nodes within (1+epsilon) of the average degree, where epsilon is given by --epsilon (default 0.1).
+- --compress-pins: with --semi-external, spill the pins of every edge delta and varint coded instead of as plain ints.
+- --compress-incidence: after loading, also keep the pins of every edge and the edges of every node delta and varint coded, and report their size and decoding speed. The greedy peeling, the max-flow network and the Gurobi models are then built from these lists instead of from a copy of the graph, for the loaded graph and for every part of it left after removing nodes that keeps at least a quarter of them, which lowers the peak memory. Results are the same, except that the peeling of unweighted graphs may break ties between nodes of equal degree differently. Applies to single runs, --serve, --batch and --uniqueness.
+- --memory-limit=<MB>: fail with a report of the memory held per structure and phase once the tracked structures or the resident set exceed the limit, instead of being killed; under a limit the algorithms also avoid holding copies they can rebuild and stream subgraphs to the result file.
+- --memory-report: print the memory held per structure and the peak of every phase at the end of the run.
+- --merge-edges: merge edges with the same node set into one edge whose weight is the sum of theirs, after sorting the pins of every edge and dropping repeated pins. Densities are unchanged while the graph, the heaps and the LP models shrink; edge ids then number the distinct edges. Unweighted inputs are read as int64. Ignored by --dynamic and --semi-external.
+- --reorder[=<degree|bfs|rcm>]: allocate nodes and edges after loading so that neighbors sit close in memory, by decreasing degree, in breadth-first order (default) or in reverse Cuthill-McKee order; ids and results are unchanged. Applies to single runs, --serve, --batch and --uniqueness.
+- --seed=<n>: seed of the random choices of MinAndRemove(2) and the uniqueness checks, where the default is the default seed of std::mt19937. Runs with the same seed and arguments give identical results; each query of --serve draws from its own stream derived from the seed and its query id, and each job of --batch from the stream of a command-line run, whatever thread runs it.
+- --lp-solver=<gurobi|flow>: backend of the LPs of NaiveDensest(0) and MinAndRemove(2). gurobi (default) solves them with the simplex method; flow solves them exactly by parametric max-flow and needs no license. Builds with GUROBI=0 have only flow.
+- --cache[=<directory>]: keep the extracted rounds on disk, keyed by a hash of the input files and the parameters other than k (including --seed and the random stream for MinAndRemove(2)), where the default directory is ./cache; a later run replays the cached rounds with the random engine saved after them and computes only the missing ones. Runs with a time budget are not cached.
 )";
 
-void RunNaiveDenest(const Hypergraph* g, const int k, vector<Hypergraph*> &ans, Output& output){
-    ans = NaiveAlgorithm::NaiveDensest(g, k, output);
+/* Options that take their value from the next argument when it has no "=". */
+vector<string> options_with_value = {"weight-type", "time-budget", "dynamic", "epsilon", "threads", "batch", "summary", "max-edge-size", "memory-limit", "seed", "lp-solver"};
+
+template<class W>
+void RunNaiveDenest(const Hypergraph<W>* g, const int k, vector<Hypergraph<W>*> &ans, Output& output, const vector<vector<int> >& prefix, Checkpoint* checkpoint){
+    ans = NaiveAlgorithm::NaiveDensest(g, k, output, prefix, checkpoint);
 }
 
-void RunNaiveApprox(const Hypergraph* g, const int k, vector<Hypergraph*> &ans, Output& output){
-    ans = NaiveAlgorithm::NaiveApprox(g, k, output);
+template<class W>
+void RunNaiveApprox(const Hypergraph<W>* g, const int k, vector<Hypergraph<W>*> &ans, Output& output, const vector<vector<int> >& prefix, Checkpoint* checkpoint){
+    ans = NaiveAlgorithm::NaiveApprox(g, k, output, prefix, checkpoint);
 }
 
-void RunMinAndRemove(const Hypergraph* g, const int k, const ld alpha, const int way_overlapness, vector<Hypergraph*> &ans, Output& output){
-    ans = ApproxMinAndRemove(g, k, alpha, false, way_overlapness, output);
+template<class W>
+void RunMinAndRemove(const Hypergraph<W>* g, const int k, const double alpha, const int way_overlapness, vector<Hypergraph<W>*> &ans, Output& output, const vector<vector<int> >& prefix, Checkpoint* checkpoint){
+    ans = ApproxMinAndRemove(g, k, alpha, false, way_overlapness, output, prefix, checkpoint);
 }
 
-void RunApproxMinAndRemove(const Hypergraph* g, const int k, const ld alpha, const int way_overlapness, vector<Hypergraph*> &ans, Output& output){
-    ans = ApproxMinAndRemove(g, k, alpha, true, way_overlapness, output);
+template<class W>
+void RunAnytimeMinAndRemove(const Hypergraph<W>* g, const int k, const double alpha, const int way_overlapness, const TimeBudget& budget, vector<Hypergraph<W>*> &ans, vector<Density<W> >& upper_bounds, Output& output){
+    ans = AnytimeMinAndRemove(g, k, alpha, way_overlapness, budget, upper_bounds, output);
 }
 
-int main(const int argc, const char* argv[]){
-    int algo = 2;
+template<class W>
+void RunApproxMinAndRemove(const Hypergraph<W>* g, const int k, const double alpha, const int way_overlapness, vector<Hypergraph<W>*> &ans, Output& output, const vector<vector<int> >& prefix, Checkpoint* checkpoint){
+    ans = ApproxMinAndRemove(g, k, alpha, true, way_overlapness, output, prefix, checkpoint);
+}
+
+/*
+ * One (algo, k, alpha, removal way) combination, given on the command line
+ * or by a query of the server mode. An empty time budget means unlimited.
+ */
+struct Query{
+int algo = 2;
+int k = 10;
+double alpha = 0;
+int way_to_remove_nodes = 1;
+string time_budget;
+};
+
+/*
+ * The weight type given by --weight-type, detected from the files for
+ * auto. Merged parallel edges carry sums of weights, so --merge-edges reads
+ * an unweighted input as int64.
+ */
+string get_weight_type(const Arguments& arguments, const string node_file, const string edge_file){
+    string weight_type = arguments.get_option("weight-type", "auto");
+    if(weight_type == "auto"){
+        weight_type = DetectWeightType(node_file.c_str(), edge_file.c_str());
+        if(weight_type == "unweighted" && arguments.has_option("merge-edges")){
+            weight_type = "int64";
+        }
+    }
+    if(weight_type == "unweighted" && arguments.has_option("merge-edges")){
+        Console::Error("--merge-edges needs weights; use --weight-type=int64.");
+    }
+    return weight_type;
+}
+
+/*
+ * Calls f.Call<W>() for the weight type W named by weight_type.
+ */
+template<class F>
+int DispatchWeightType(const string& weight_type, F f){
+    if(weight_type == "double"){
+        return f.template Call<double>();
+    }else if(weight_type == "long-double"){
+        return f.template Call<long double>();
+    }else if(weight_type == "int64"){
+        return f.template Call<int64_t>();
+    }else if(weight_type == "unweighted"){
+        return f.template Call<Unweighted>();
+    }
+    Console::Error("Unknown weight type <" + weight_type + ">." + info);
+    return 1;
+}
+
+/*
+ * Reads the hypergraph as given by --merge-edges and, with --reorder,
+ * replaces it by a copy laid out for locality. With --compress-incidence
+ * the graph also gets its compressed incidence.
+ */
+template<class W>
+Hypergraph<W>* LoadHypergraph(const string node_file, const string edge_file, const Arguments& arguments){
+    Hypergraph<W>* g = new Hypergraph<W>(node_file.c_str(), edge_file.c_str(), arguments.has_option("merge-edges"));
+    if(arguments.has_option("reorder")){
+        string way = arguments.get_option("reorder", "bfs");
+        Hypergraph<W>* h = g->GenerateReordering(way.empty() ? "bfs" : way);
+        delete g;
+        g = h;
+    }
+    if(arguments.has_option("compress-incidence")){
+        g->Compress();
+        const CompressedIncidence<W>* incidence = g->get_incidence();
+        Console::Show("Incidence of " + std::to_string(incidence->get_bytes_of_lists()) + " bytes (compression ratio " + Double2String((double)incidence->get_bytes_of_plain_lists() / std::max(incidence->get_bytes_of_lists(), (int64_t)1)) + "), decoded at " + Double2String(incidence->MeasureDecoding() / 1e6) + "M pins/s.");
+    }
+    return g;
+}
+
+string get_output_file_name(const string node_file, const Query& query){
+    string output_file_name = "./result/" + RetrieveFileName(node_file);
+    if(query.algo == 0 || query.algo == 1){
+        if(query.algo == 0){
+            output_file_name += "_[NaiveDensest(0)]";
+        }else{
+            output_file_name += "_[NaiveApprox(1)]";
+        }
+        output_file_name += "_k=" + Int2String(query.k);
+    }else{
+        if(query.algo == 2){
+            output_file_name += "_[MinAndRemove(2)]";
+        }else{
+            output_file_name += "_[ApproxMinAndRemove(3)]";
+        }
+        output_file_name += "_k=" + Int2String(query.k) + "_alpha=" + Double2String(query.alpha) + "_removalway=" + Int2String(query.way_to_remove_nodes);
+        if(query.algo == 2 && !query.time_budget.empty()){
+            output_file_name += "_budget=" + query.time_budget;
+        }
+    }
+    return output_file_name;
+}
+
+template<class W>
+vector<Hypergraph<W>*> RunQuery(const Hypergraph<W>* g, const Query& query, const TimeBudget& budget, vector<Density<W> >& upper_bounds, Output& output, const vector<vector<int> >& prefix, Checkpoint* checkpoint){
+    int n = g->get_number_of_nodes();
+    int m = g->get_number_of_edges();
+    int k = query.k;
+    double alpha = query.alpha;
+    vector<Hypergraph<W>*> ans;
+    if(query.algo == 0){
+        Console::Show("We perform [NaiveDensest(0)] on a dataset with " + Int2String(n) + " nodes and " + Int2String(m) + " edges with [k = " + Int2String(k) + "].");
+        RunNaiveDenest(g, k, ans, output, prefix, checkpoint);
+    }else if(query.algo == 1){
+        Console::Show("We perform [NaiveApprox(1)] on a dataset with " + Int2String(n) + " nodes and " + Int2String(m) + " edges with [k = " + Int2String(k) + "].");
+        RunNaiveApprox(g, k, ans, output, prefix, checkpoint);
+    }else if(query.algo == 2){
+        Console::Show("We perform [MinAndRemove(2)] on a dataset with " + Int2String(n) + " nodes and " + Int2String(m) + " edges with [k = " + Int2String(k) + "], [alpha = " + Double2String(alpha) + "].");
+        if(budget.is_limited()){
+            Console::Show("Time budget is " + Double2String(budget.get_remaining_seconds()) + " sec.");
+            RunAnytimeMinAndRemove(g, k, alpha, query.way_to_remove_nodes, budget, ans, upper_bounds, output);
+        }else{
+            RunMinAndRemove(g, k, alpha, query.way_to_remove_nodes, ans, output, prefix, checkpoint);
+        }
+    }else if(query.algo == 3){
+        Console::Show("We perform [ApproxMinAndRemove(3)] on a dataset with " + Int2String(n) + " nodes and " + Int2String(m) + " edges with [k = " + Int2String(k) + "], [alpha = " + Double2String(alpha) + "].");
+        RunApproxMinAndRemove(g, k, alpha, query.way_to_remove_nodes, ans, output, prefix, checkpoint);
+    }
+    return ans;
+}
+
+/*
+ * Results are cached per input fingerprint and parameters other than k,
+ * including the seed and the stream of the random choices of
+ * MinAndRemove(2) and --compress-incidence, which may break peeling ties
+ * differently; runs with a time budget are never cached.
+ */
+template<class W>
+ResultCache* get_result_cache(const Arguments& arguments, const string fingerprint, const Query& query, const int stream){
+    if(!arguments.has_option("cache") || !query.time_budget.empty()){
+        return nullptr;
+    }
+    string directory = arguments.get_option("cache", "");
+    string key = fingerprint + "_" + WeightTypeName<W>() + "_algo=" + Int2String(query.algo);
+    if(arguments.has_option("merge-edges")){
+        key += "_merged";
+    }
+    if(arguments.has_option("compress-incidence")){
+        key += "_compressed";
+    }
+    if(query.algo == 0 || query.algo == 2){
+        key += "_lp=" + LpSolver<W>::get_backend();
+    }
+    if(query.algo == 2){
+        key += "_seed=" + std::to_string(get_random_seed()) + "_stream=" + Int2String(stream);
+    }
+    if(query.algo == 2 || query.algo == 3){
+        key += "_alpha=" + Double2String(query.alpha) + "_removalway=" + Int2String(query.way_to_remove_nodes);
+    }
+    return new ResultCache(directory.empty() ? "./cache" : directory, key);
+}
+
+template<class W>
+vector<Hypergraph<W>*> RunCachedQuery(const Hypergraph<W>* g, const Query& query, const TimeBudget& budget, vector<Density<W> >& upper_bounds, Output& output, const ResultCache* cache, Checkpoint* checkpoint){
+    vector<vector<int> > prefix;
+    vector<double> densities;
+    string random_state;
+    if(cache != nullptr && cache->Load(prefix, densities, random_state)){
+        Console::Show("Resuming from " + Int2String(prefix.size()) + " cached rounds in <" + cache->get_path() + ">.");
+        /* Replaying draws nothing, so the engine can be restored up front. */
+        if(!random_state.empty()){
+            std::stringstream ss(random_state);
+            ss >> get_random_engine();
+        }else if(query.algo == 2){
+            prefix.clear();
+        }
+    }
+    vector<Hypergraph<W>*> ans = RunQuery(g, query, budget, upper_bounds, output, prefix, checkpoint);
+    if(cache != nullptr && ans.size() > prefix.size()){
+        prefix.clear();
+        densities.clear();
+        for(const auto& x:ans){
+            set node_set = x->get_node_set();
+            prefix.push_back(vector<int>(node_set.begin(), node_set.end()));
+            std::sort(prefix.back().begin(), prefix.back().end());
+            densities.push_back(x->get_density());
+        }
+        std::stringstream ss;
+        ss << get_random_engine();
+        cache->Save(prefix, densities, ss.str());
+    }
+    return ans;
+}
+
+template<class W>
+int Run(const vector<string>& args, const Arguments& arguments, const TimeBudget& budget){
+    Query query;
+    query.time_budget = budget.is_limited() ? arguments.get_option("time-budget", "0") : "";
+    Hypergraph<W>* g = nullptr;
+    tik
+    switch(args.size()){
+        case 7:
+            query.way_to_remove_nodes = String2Int(args[6]);
+            // fall through
+        case 6:
+            query.alpha = String2Double(args[5]);
+            // fall through
+        case 5:
+            query.k = String2Int(args[4]);
+            // fall through
+        case 4:
+            query.algo = String2Int(args[3]);
+            // fall through
+        case 3:{
+            MemoryPhase phase("load");
+            Console::Show("Reading hypergraph...");
+            g = LoadHypergraph<W>(args[1], args[2], arguments);
+            Console::Show("Done. Weights are stored as " + string(WeightTypeName<W>()) + ".");
+            break;
+        }
+        default:
+            Console::Error(info);
+    }
+    if(query.algo < 0 || query.algo > 3){
+		Console::Error(info);
+	}
+    string output_file_name = get_output_file_name(args[1], query);
+    Checkpoint* checkpoint = nullptr;
+    bool is_resumed = false;
+    if((arguments.has_option("checkpoint") || arguments.has_option("resume")) && query.time_budget.empty()){
+        checkpoint = new Checkpoint(output_file_name + ".checkpoint", ResultCache::Fingerprint(args[1], args[2]) + " " + WeightTypeName<W>() + (arguments.has_option("merge-edges") ? " merged " : " ") + (arguments.has_option("compress-incidence") ? "compressed " : "") + "seed=" + std::to_string(get_random_seed()) + " " + output_file_name);
+        is_resumed = arguments.has_option("resume") && checkpoint->Load();
+    }
+    if(is_resumed && truncate(output_file_name.c_str(), checkpoint->get_output_size()) != 0){
+        Console::Error("Can't truncate <" + output_file_name + ">!");
+    }
+    Output* output = is_resumed ? new Output(0, output_file_name.c_str()) : new Output(output_file_name.c_str());
+    vector<Density<W> > upper_bounds;
+    ResultCache* cache = get_result_cache<W>(arguments, arguments.has_option("cache") ? ResultCache::Fingerprint(args[1], args[2]) : "", query, 0);
+    vector<Hypergraph<W>*> ans = RunCachedQuery(g, query, budget, upper_bounds, *output, cache, checkpoint);
+    delete cache;
+    tok
+    Density<W> sum = 0.0;
+    for(const auto& g:ans){
+        sum += g->get_density();
+    }
+    Console::Show("Total value is " + Double2String(sum) + ".");
+    output->PrintLine("Total value is " + Double2String(sum) + ".");
+    if(!upper_bounds.empty()){
+        Density<W> sum_of_upper_bounds = 0.0;
+        for(const auto& x:upper_bounds){
+            sum_of_upper_bounds += x;
+        }
+        Console::Show("Total upper bound is " + Double2String(sum_of_upper_bounds) + ".");
+        output->PrintLine("Total upper bound is " + Double2String(sum_of_upper_bounds) + ".");
+    }
+
+    if(is_resumed){
+        string total_elapsed = "Elapsed time: " + Double2String(checkpoint->get_elapsed() + std::chrono::duration<double>(time_end - time_start).count()) + " sec.";
+        Console::Show(total_elapsed);
+        output->PrintLine(total_elapsed);
+    }else{
+        Console::Show(elapsed);
+        output->PrintLine(elapsed);
+    }
+    if(checkpoint != nullptr){
+        checkpoint->Remove();
+        delete checkpoint;
+    }
+    delete output;
+    if(arguments.has_option("memory-report") || MemoryTracker::is_limited()){
+        Console::Show(MemoryTracker::Report());
+    }
+    return 0;
+}
+
+/**********Server**********/
+
+/*
+ * A client of the server mode. Replies go to the socket, or to stdout when
+ * queries come from stdin; the socket is closed after the last reply.
+ */
+class Session{
+
+private:
+int fd_;
+std::mutex mutex_;
+
+public:
+Session(const int fd): fd_(fd){}
+~Session(){
+    if(fd_ >= 0){
+        close(fd_);
+    }
+}
+void Send(const string line){
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(fd_ < 0){
+        std::cout << line << std::endl;
+        return;
+    }
+    string buff = line + "\n";
+    for(size_t sent = 0; sent < buff.length();){
+        ssize_t cnt = send(fd_, buff.data() + sent, buff.length() - sent, MSG_NOSIGNAL);
+        if(cnt <= 0){
+            return;
+        }
+        sent += cnt;
+    }
+}
+
+};
+
+string ToJson(const string str){
+    string ans = "\"";
+    for(const auto& x:str){
+        if(x == '"' || x == '\\'){
+            ans += '\\';
+        }
+        ans += x;
+    }
+    return ans + "\"";
+}
+
+/*
+ * A query line is "<algo> <k> <alpha> <removal way> [time budget]", with
+ * the same meaning and defaults as the positional arguments.
+ */
+bool ParseQuery(const string line, Query& query, string& error){
+    std::stringstream ss(line);
+    vector<string> tokens;
+    string token;
+    while(ss >> token){
+        char* end = nullptr;
+        strtod(token.c_str(), &end);
+        if(*end != '\0'){
+            error = "<" + token + "> is not a number";
+            return false;
+        }
+        tokens.push_back(token);
+    }
+    switch(tokens.size()){
+        case 5:
+            query.time_budget = tokens[4];
+            // fall through
+        case 4:
+            query.way_to_remove_nodes = String2Int(tokens[3]);
+            // fall through
+        case 3:
+            query.alpha = String2Double(tokens[2]);
+            // fall through
+        case 2:
+            query.k = String2Int(tokens[1]);
+            // fall through
+        case 1:
+            query.algo = String2Int(tokens[0]);
+            break;
+        default:
+            error = "expected <algo> <k> <alpha> <removal way> [time budget]";
+            return false;
+    }
+    if(query.algo < 0 || query.algo > 3){
+        error = "algo must be 0, 1, 2 or 3";
+        return false;
+    }
+    if(query.k <= 0){
+        error = "k must be positive";
+        return false;
+    }
+    if(query.way_to_remove_nodes != 1 && query.way_to_remove_nodes != 2){
+        error = "removal way must be 1 or 2";
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Outcome of one query on a loaded graph.
+ */
+struct QueryResult{
+vector<double> densities;
+double total = 0;
+bool has_upper_bound = false;
+double upper_bound = 0;
+double seconds = 0;
+};
+
+/*
+ * Every query works on residual graphs over the shared base graph, which
+ * copy a node only once the query removes it, so queries never wait for
+ * each other and only the extracted subgraphs are materialized. The result file is written as by a
+ * command-line run; the random engine is restarted for stream, so the
+ * result does not depend on the thread or the other queries.
+ */
+template<class W>
+QueryResult RunLoadedQuery(const Hypergraph<W>* g, const string output_file_name, const string fingerprint, const Arguments& arguments, const Query& query, const int stream){
+    tik
+    SeedRandomEngine(stream);
+    TimeBudget budget;
+    if(!query.time_budget.empty()){
+        budget = TimeBudget(String2Double(query.time_budget));
+    }
+    Output output(output_file_name.c_str());
+    vector<Density<W> > upper_bounds;
+    ResultCache* cache = get_result_cache<W>(arguments, fingerprint, query, stream);
+    vector<Hypergraph<W>*> ans = RunCachedQuery(g, query, budget, upper_bounds, output, cache, nullptr);
+    delete cache;
+    tok
+    QueryResult result;
+    Density<W> sum = 0.0;
+    for(const auto& x:ans){
+        sum += x->get_density();
+        result.densities.push_back(x->get_density());
+        delete x;
+    }
+    result.total = sum;
+    output.PrintLine("Total value is " + Double2String(sum) + ".");
+    if(!upper_bounds.empty()){
+        Density<W> sum_of_upper_bounds = 0.0;
+        for(const auto& x:upper_bounds){
+            sum_of_upper_bounds += x;
+        }
+        output.PrintLine("Total upper bound is " + Double2String(sum_of_upper_bounds) + ".");
+        result.has_upper_bound = true;
+        result.upper_bound = sum_of_upper_bounds;
+    }
+    output.PrintLine(elapsed);
+    result.seconds = std::chrono::duration<double>(time_end - time_start).count();
+    return result;
+}
+
+template<class W>
+string Answer(const Hypergraph<W>* g, const string node_file, const string fingerprint, const Arguments& arguments, const int id, const Query& query){
+    string output_file_name = get_output_file_name(node_file, query) + "_query=" + Int2String(id);
+    QueryResult result = RunLoadedQuery(g, output_file_name, fingerprint, arguments, query, id);
+    string densities;
+    for(const auto& x:result.densities){
+        densities += (densities.empty() ? "" : ", ") + Double2String(x);
+    }
+    string reply = "{\"id\": " + Int2String(id) + ", \"algo\": " + Int2String(query.algo) + ", \"k\": " + Int2String(query.k) + ", \"alpha\": " + Double2String(query.alpha) + ", \"way\": " + Int2String(query.way_to_remove_nodes) + ", \"densities\": [" + densities + "], \"total\": " + Double2String(result.total);
+    if(result.has_upper_bound){
+        reply += ", \"upper_bound\": " + Double2String(result.upper_bound);
+    }
+    reply += ", \"seconds\": " + Double2String(result.seconds) + ", \"output\": " + ToJson(output_file_name) + "}";
+    return reply;
+}
+
+template<class W>
+void HandleLine(const Hypergraph<W>* g, const string node_file, const string fingerprint, const Arguments& arguments, const string line, std::shared_ptr<Session> session, std::atomic<int>& number_of_queries, ThreadPool& pool){
+    if(line.find_first_not_of(" \t\r") == string::npos){
+        return;
+    }
+    Query query;
+    string error;
+    int id = ++number_of_queries;
+    if(!ParseQuery(line, query, error)){
+        session->Send("{\"id\": " + Int2String(id) + ", \"error\": " + ToJson(error) + "}");
+        return;
+    }
+    pool.Submit([=, &arguments](){
+        try{
+            session->Send(Answer(g, node_file, fingerprint, arguments, id, query));
+        }catch(...){
+            session->Send("{\"id\": " + Int2String(id) + ", \"error\": \"the solver failed\"}");
+        }
+    });
+}
+
+template<class W>
+int Serve(const vector<string>& args, const Arguments& arguments){
+    if(args.size() != 3){
+        Console::Error(info);
+    }
+    Console::Show("Reading hypergraph...");
+    const Hypergraph<W>* g = LoadHypergraph<W>(args[1], args[2], arguments);
+    Console::Show("Done. Weights are stored as " + string(WeightTypeName<W>()) + ".");
+    string fingerprint = arguments.has_option("cache") ? ResultCache::Fingerprint(args[1], args[2]) : "";
+    ThreadPool& pool = ThreadPool::get_shared();
+    std::atomic<int> number_of_queries(0);
+    string address = arguments.get_option("serve", "");
+    if(address.empty() || address == "-"){
+        Console::Show("Serving queries from stdin with " + Int2String(pool.get_number_of_threads()) + " threads.");
+        auto session = std::make_shared<Session>(-1);
+        string line;
+        while(std::getline(std::cin, line) && line != "quit"){
+            HandleLine(g, args[1], fingerprint, arguments, line, session, number_of_queries, pool);
+        }
+        pool.Wait();
+        delete g;
+        return 0;
+    }
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, address.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(address.c_str());
+    if(server < 0 || bind(server, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(server, 16) < 0){
+        Console::Error("Cannot listen on <" + address + ">.");
+    }
+    Console::Show("Serving queries on " + address + " with " + Int2String(pool.get_number_of_threads()) + " threads.");
+    while(true){
+        int fd = accept(server, nullptr, nullptr);
+        if(fd < 0){
+            continue;
+        }
+        std::thread([&, fd](){
+            auto session = std::make_shared<Session>(fd);
+            string buff;
+            char chunk[4096];
+            ssize_t cnt;
+            while((cnt = read(fd, chunk, sizeof(chunk))) > 0){
+                buff.append(chunk, cnt);
+                size_t pos;
+                while((pos = buff.find('\n')) != string::npos){
+                    string line = buff.substr(0, pos);
+                    buff.erase(0, pos + 1);
+                    if(line == "quit" || line == "quit\r"){
+                        return;
+                    }
+                    HandleLine(g, args[1], fingerprint, arguments, line, session, number_of_queries, pool);
+                }
+            }
+            HandleLine(g, args[1], fingerprint, arguments, buff, session, number_of_queries, pool);
+        }).detach();
+    }
+    return 0;
+}
+
+/**********Batch**********/
+
+/*
+ * A line of the manifest: the two files and the optional positional
+ * arguments of a command-line run.
+ */
+struct Job{
+int line;
+string node_file, edge_file;
+Query query;
+string weight_type;
+string output_file_name;
+QueryResult result;
+string error;
+};
+
+bool ParseJob(const string line, Job& job, string& error){
+    std::stringstream ss(line);
+    if(!(ss >> job.node_file >> job.edge_file)){
+        error = "expected <nodes file> <hypergraph file> [algo] [k] [alpha] [removal way]";
+        return false;
+    }
+    string rest, token;
+    while(ss >> token){
+        rest += token + " ";
+    }
+    if(rest.empty()){
+        return true;
+    }
+    if(!ParseQuery(rest, job.query, error)){
+        return false;
+    }
+    if(!job.query.time_budget.empty()){
+        error = "expected at most 6 fields";
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Errors on the batch path end the whole run, so the files a job reads
+ * and writes are checked before it is submitted; a job failing the check
+ * is only reported in the summary.
+ */
+bool CheckJob(const Job& job, string& error){
+    for(const auto& path:{job.node_file, job.edge_file}){
+        if(!std::ifstream(path).good()){
+            error = "can't open <" + path + ">";
+            return false;
+        }
+    }
+    if(!std::ofstream(job.output_file_name, std::ios::app).good()){
+        error = "can't open <" + job.output_file_name + ">";
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Loads the dataset once; its jobs share the graph, which is freed by the
+ * last of them.
+ */
+template<class W>
+void RunDataset(vector<Job*> jobs, const Arguments& arguments, ThreadPool& pool){
+    std::shared_ptr<const Hypergraph<W> > g(LoadHypergraph<W>(jobs[0]->node_file, jobs[0]->edge_file, arguments));
+    Console::Show("Loaded " + jobs[0]->node_file + " with " + Int2String(g->get_number_of_nodes()) + " nodes and " + Int2String(g->get_number_of_edges()) + " edges as " + WeightTypeName<W>() + ".");
+    string fingerprint = arguments.has_option("cache") ? ResultCache::Fingerprint(jobs[0]->node_file, jobs[0]->edge_file) : "";
+    for(auto job:jobs){
+        job->weight_type = WeightTypeName<W>();
+        pool.Submit([=, &arguments](){
+            job->result = RunLoadedQuery(g.get(), job->output_file_name, fingerprint, arguments, job->query, 0);
+            Console::Show("Job of line " + Int2String(job->line) + " done: total value " + Double2String(job->result.total) + " in " + Double2String(job->result.seconds) + " sec.");
+        });
+    }
+}
+
+struct DatasetRunner{
+const vector<Job*>& jobs;
+const Arguments& arguments;
+ThreadPool& pool;
+template<class W> int Call() const{
+    RunDataset<W>(jobs, arguments, pool);
+    return 0;
+}
+};
+
+void RunDataset(const vector<Job*> jobs, const Arguments& arguments, ThreadPool& pool){
+    DispatchWeightType(get_weight_type(arguments, jobs[0]->node_file, jobs[0]->edge_file), DatasetRunner{jobs, arguments, pool});
+}
+
+/*
+ * Runs every job of the manifest, loading each dataset once, and writes a
+ * summary table with one row per job in manifest order. Malformed lines,
+ * jobs failing CheckJob and jobs whose result file an earlier line
+ * already writes are skipped and get an error in the table. Every job
+ * draws from stream 0, as a command-line run does.
+ */
+int RunBatch(const Arguments& arguments){
+    tik
+    string manifest = arguments.get_option("batch", "");
+    Input input(manifest.c_str());
+    std::stringstream ss;
+    vector<Job> jobs;
+    std::map<string, int> line_of_output;
+    for(int line = 1; input.NextLine(ss); ++line){
+        string str = ss.str();
+        if(str.find_first_not_of(" \t\r") == string::npos || str[str.find_first_not_of(" \t\r")] == '#'){
+            continue;
+        }
+        Job job;
+        string error;
+        job.line = line;
+        if(!ParseJob(str, job, error)){
+            job.error = error;
+        }else{
+            if(arguments.has_option("time-budget")){
+                job.query.time_budget = arguments.get_option("time-budget", "0");
+            }
+            job.output_file_name = get_output_file_name(job.node_file, job.query);
+            auto x = line_of_output.insert(std::make_pair(job.output_file_name, line));
+            if(!x.second){
+                job.error = "same result file as line " + Int2String(x.first->second);
+            }else{
+                CheckJob(job, job.error);
+            }
+        }
+        if(!job.error.empty()){
+            Console::Show("Skipping line " + Int2String(line) + " of <" + manifest + ">: " + job.error + ".");
+        }
+        jobs.push_back(job);
+    }
+    std::map<std::pair<string, string>, vector<Job*> > datasets;
+    int number_of_runnable_jobs = 0;
+    for(auto& x:jobs){
+        if(x.error.empty()){
+            datasets[std::make_pair(x.node_file, x.edge_file)].push_back(&x);
+            ++number_of_runnable_jobs;
+        }
+    }
+    ThreadPool& pool = ThreadPool::get_shared();
+    Console::Show("Running " + Int2String(number_of_runnable_jobs) + " jobs on " + Int2String(datasets.size()) + " datasets with " + Int2String(pool.get_number_of_threads()) + " threads.");
+    for(const auto& x:datasets){
+        vector<Job*> dataset_jobs = x.second;
+        pool.Submit([dataset_jobs, &arguments, &pool](){
+            RunDataset(dataset_jobs, arguments, pool);
+        });
+    }
+    pool.Wait();
+    tok
+
+    string summary_file_name = arguments.get_option("summary", "./result/" + RetrieveFileName(manifest) + "_[Batch]_summary");
+    Output summary(summary_file_name.c_str());
+    summary.PrintLine("line\tdataset\tweight\talgo\tk\talpha\tway\trounds\ttotal\tupper_bound\tseconds\toutput\terror");
+    int number_of_failed_jobs = 0;
+    for(const auto& x:jobs){
+        if(!x.error.empty()){
+            ++number_of_failed_jobs;
+            summary.PrintLine(Int2String(x.line) + "\t" + RetrieveFileName(x.node_file) + "\t-\t-\t-\t-\t-\t-\t-\t-\t-\t-\t" + x.error);
+            continue;
+        }
+        summary.PrintLine(Int2String(x.line) + "\t" + RetrieveFileName(x.node_file) + "\t" + x.weight_type + "\t" + Int2String(x.query.algo) + "\t" + Int2String(x.query.k) + "\t" + Double2String(x.query.alpha) + "\t" + Int2String(x.query.way_to_remove_nodes) + "\t" + Int2String(x.result.densities.size()) + "\t" + Double2String(x.result.total) + "\t" + (x.result.has_upper_bound ? Double2String(x.result.upper_bound) : "-") + "\t" + Double2String(x.result.seconds) + "\t" + x.output_file_name + "\t-");
+    }
+    summary.PrintLine(elapsed);
+    if(number_of_failed_jobs > 0){
+        Console::Show(Int2String(number_of_failed_jobs) + " of " + Int2String(jobs.size()) + " jobs failed; see the error column of the summary.");
+    }
+    Console::Show("Summary is written to <" + summary_file_name + ">.");
+    Console::Show(elapsed);
+    return 0;
+}
+
+template<class W>
+void ReportDynamic(const DynamicDensestSubgraph<W>& dynamic, Output& output){
+    string report = "After " + Int2String(dynamic.get_number_of_updates()) + " updates: density = " + Double2String(dynamic.get_density()) + ", upper bound = " + Double2String(dynamic.get_upper_bound()) + ", " + Int2String(dynamic.get_number_of_recomputes()) + " recomputes (" + Int2String(dynamic.get_number_of_exact_recomputes()) + " exact), " + Int2String(dynamic.get_number_of_rebuilds()) + " level rebuilds, " + std::to_string(dynamic.get_number_of_moves()) + " share moves.";
+    Console::Show(report);
+    output.PrintLine(report);
+    vector<Hypergraph<W>*> ans = dynamic.get_subgraphs();
+    Density<W> sum = 0.0;
+    for(int i = 0; i < (int)ans.size(); ++i){
+        Console::Show("[" + Int2String(i + 1) + "]\t" + Int2String(ans[i]->get_number_of_nodes()) + " nodes, " + Int2String(ans[i]->get_number_of_edges()) + " edges, density = " + Double2String(ans[i]->get_density()));
+        #ifndef TURNOFFGRAPHOUTPUT
+        ans[i]->Print(output, FEATURE("Density", Double2String(ans[i]->get_density())));
+        #endif // TURNOFFGRAPHOUTPUT
+        sum += ans[i]->get_density();
+        delete ans[i];
+    }
+    Console::Show("Total value is " + Double2String(sum) + ".");
+    output.PrintLine("Total value is " + Double2String(sum) + ".");
+}
+
+template<class W>
+int RunDynamic(const vector<string>& args, const Arguments& arguments){
     int k = 10;
     double alpha = 0;
     int way_to_remove_nodes = 1;
-    Hypergraph* g = nullptr;
+    double epsilon = String2Double(arguments.get_option("epsilon", "0.1"));
+    DynamicHypergraph<W>* g = nullptr;
     tik
-    switch(argc){
+    switch(args.size()){
         case 7:
-            way_to_remove_nodes = String2Int(argv[6]);
+            way_to_remove_nodes = String2Int(args[6]);
+            // fall through
         case 6:
-            alpha = String2Double(argv[5]);
+            alpha = String2Double(args[5]);
+            // fall through
         case 5:
-            k = String2Int(argv[4]);
+            k = String2Int(args[4]);
+            // fall through
         case 4:
-            algo = String2Int(argv[3]);
         case 3:
             Console::Show("Reading hypergraph...");
-            g = new Hypergraph(argv[1], argv[2]);
-            Console::Show("Done.");
+            g = new DynamicHypergraph<W>(args[1].c_str(), args[2].c_str());
+            Console::Show("Done. Weights are stored as " + string(WeightTypeName<W>()) + ".");
             break;
         default:
             Console::Error(info);
     }
-    int n = g->get_number_of_nodes();
-    int m = g->get_number_of_edges();
-    string output_file_name = "./result/" + RetrieveFileName(argv[1]);
-    if(algo == 0 || algo == 1){
-        if(algo == 0){
-            output_file_name += "_[NaiveDensest(0)]";
-        }else{
-            output_file_name += "_[NaiveApprox(1)]";
+    string output_file_name = "./result/" + RetrieveFileName(args[1]) + "_[Dynamic]_k=" + Int2String(k) + "_alpha=" + Double2String(alpha) + "_removalway=" + Int2String(way_to_remove_nodes) + "_epsilon=" + Double2String(epsilon);
+    Output output(output_file_name.c_str());
+    Console::Show("We maintain [Dynamic] subgraphs on a dataset with " + Int2String(g->get_number_of_nodes()) + " nodes and " + Int2String(g->get_number_of_edges()) + " edges with [k = " + Int2String(k) + "], [alpha = " + Double2String(alpha) + "], [epsilon = " + Double2String(epsilon) + "].");
+    DynamicDensestSubgraph<W> dynamic(g, epsilon, k, alpha, way_to_remove_nodes);
+
+    Input updates(arguments.get_option("dynamic", "").c_str());
+    std::stringstream line;
+    int number_of_skipped_updates = 0;
+    while(updates.NextLine(line)){
+        string operation;
+        if(!(line >> operation) || operation[0] == '#'){
+            continue;
         }
-        output_file_name += "_k=" + Int2String(k);
-    }else if(algo == 2 || algo == 3){
-        if(algo == 2){
-            output_file_name += "_[MinAndRemove(2)]";
+        bool is_applied = true;
+        if(operation == "+n"){
+            int node_id;
+            string token;
+            Weight<W> weight;
+            if(!(line >> node_id >> token) || !String2Value(token, weight)){
+                Console::Error("Malformed update <" + line.str() + "> for weights stored as " + WeightTypeName<W>() + ".");
+            }
+            is_applied = dynamic.InsertNode(node_id, weight);
+        }else if(operation == "-n"){
+            int node_id;
+            if(!(line >> node_id)){
+                Console::Error("Malformed update <" + line.str() + ">.");
+            }
+            is_applied = dynamic.DeleteNode(node_id);
+        }else if(operation == "+e"){
+            string pins;
+            string token;
+            Weight<W> weight;
+            if(!(line >> pins >> token) || !String2Value(token, weight)){
+                Console::Error("Malformed update <" + line.str() + "> for weights stored as " + WeightTypeName<W>() + ".");
+            }
+            for(auto& x:pins){
+                if(x == ','){
+                    x = ' ';
+                }
+            }
+            std::stringstream ss(pins);
+            vector<int> nodes;
+            int node_id;
+            while(ss >> node_id){
+                nodes.push_back(node_id);
+            }
+            int edge_id = dynamic.InsertEdge(nodes, weight);
+            is_applied = edge_id >= 0;
+            if(is_applied){
+                output.PrintLine("Inserted edge " + Int2String(edge_id) + ".");
+            }
+        }else if(operation == "-e"){
+            int edge_id;
+            if(!(line >> edge_id)){
+                Console::Error("Malformed update <" + line.str() + ">.");
+            }
+            is_applied = dynamic.DeleteEdge(edge_id);
+        }else if(operation == "?"){
+            dynamic.Refresh();
+            ReportDynamic(dynamic, output);
         }else{
-            output_file_name += "_[ApproxMinAndRemove(3)]";
+            Console::Error("Unknown update <" + line.str() + ">.");
         }
-        output_file_name += "_k=" + Int2String(k) + "_alpha=" + Double2String(alpha) + "_removalway=" + Int2String(way_to_remove_nodes);
-    }else{
-		Console::Error(info);
-	}
+        if(!is_applied){
+            ++number_of_skipped_updates;
+            Console::Log("Skipped update <" + line.str() + ">.");
+        }
+    }
+    if(number_of_skipped_updates > 0){
+        Console::Show(Int2String(number_of_skipped_updates) + " updates referred to missing or existing objects and were skipped.");
+    }
+    dynamic.Refresh();
+    ReportDynamic(dynamic, output);
+    tok
+    Console::Show(elapsed);
+    output.PrintLine(elapsed);
+    return 0;
+}
+
+template<class W>
+int RunUniqueness(const vector<string>& args, const Arguments& arguments){
+    tik
+    Console::Show("Reading hypergraph...");
+    Hypergraph<W>* g = LoadHypergraph<W>(args[1], args[2], arguments);
+    Console::Show("Done. Weights are stored as " + string(WeightTypeName<W>()) + ".");
+    string output_file_name = "./result/" + RetrieveFileName(args[1]) + "_[Uniqueness]";
     Output output(output_file_name.c_str());
-    vector<Hypergraph*> ans;
-    if(algo == 0){
-        Console::Show("We perform [NaiveDensest(0)] on a dataset with " + Int2String(n) + " nodes and " + Int2String(m) + " edges with [k = " + Int2String(k) + "].");
-        RunNaiveDenest(g, k, ans, output);
-    }else if(algo == 1){
-        Console::Show("We perform [NaiveApprox(1)] on a dataset with " + Int2String(n) + " nodes and " + Int2String(m) + " edges with [k = " + Int2String(k) + "].");
-        RunNaiveApprox(g, k, ans, output);
-    }else if(algo == 2){
-        Console::Show("We perform [MinAndRemove(2)] on a dataset with " + Int2String(n) + " nodes and " + Int2String(m) + " edges with [k = " + Int2String(k) + "], [alpha = " + Double2String(alpha) + "].");
-        RunMinAndRemove(g, k, alpha, way_to_remove_nodes, ans, output);
-    }else if(algo == 3){
-        Console::Show("We perform [ApproxMinAndRemove(3)] on a dataset with " + Int2String(n) + " nodes and " + Int2String(m) + " edges with [k = " + Int2String(k) + "], [alpha = " + Double2String(alpha) + "].");
-        RunApproxMinAndRemove(g, k, alpha, way_to_remove_nodes, ans, output);
+    Console::Show("We perform [Uniqueness] on a dataset with " + Int2String(g->get_number_of_nodes()) + " nodes and " + Int2String(g->get_number_of_edges()) + " edges.");
+    DensestSubgraphCertificate<W> certificate = FlowAlgorithm::Solve((const Hypergraph<W>*)g);
+    string report = "Densest density = " + Double2String(certificate.density) + ", maximal densest subgraph has " + Int2String(certificate.maximal_node_set.size()) + " nodes, " + Int2String(certificate.minimal_node_sets.size()) + " minimal densest subgraphs, " + Int2String(certificate.number_of_flows) + " max-flows.";
+    Console::Show(report);
+    output.PrintLine(report);
+    for(int i = 0; i < (int)certificate.minimal_node_sets.size(); ++i){
+        Hypergraph<W>* h = GenerateInducedSubgraph((const Hypergraph<W>*)g, certificate.minimal_node_sets[i]);
+        Console::Show("[" + Int2String(i + 1) + "]\t" + Int2String(h->get_number_of_nodes()) + " nodes, " + Int2String(h->get_number_of_edges()) + " edges, density = " + Double2String(h->get_density()));
+        #ifndef TURNOFFGRAPHOUTPUT
+        h->Print(output, FEATURE("Density", Double2String(h->get_density())));
+        #endif // TURNOFFGRAPHOUTPUT
+        delete h;
     }
+    string verdict = certificate.is_unique() ? "The minimal densest subgraph is unique." : "The minimal densest subgraph is not unique.";
+    Console::Show(verdict);
+    output.PrintLine(verdict);
+    delete g;
     tok
-    ld sum = 0.0;
-    for(const auto& g:ans){
-        sum += g->get_density();
+    Console::Show(elapsed);
+    output.PrintLine(elapsed);
+    return 0;
+}
+
+/*
+ * NaiveApprox(1) and ApproxMinAndRemove(3) with the edges on disk; the
+ * spill file goes to the given directory, by default next to the
+ * hypergraph file.
+ */
+template<class W>
+int RunSemiExternal(const vector<string>& args, const Arguments& arguments){
+    Query query;
+    query.algo = 3;
+    switch(args.size()){
+        case 7:
+            query.way_to_remove_nodes = String2Int(args[6]);
+            // fall through
+        case 6:
+            query.alpha = String2Double(args[5]);
+            // fall through
+        case 5:
+            query.k = String2Int(args[4]);
+            // fall through
+        case 4:
+            query.algo = String2Int(args[3]);
+            // fall through
+        case 3:
+            break;
+        default:
+            Console::Error(info);
+    }
+    if(query.algo != 1 && query.algo != 3){
+        Console::Error("--semi-external runs NaiveApprox(1) and ApproxMinAndRemove(3) only." + info);
+    }
+    double epsilon = String2Double(arguments.get_option("epsilon", "0.1"));
+    string spill_directory = arguments.get_option("semi-external", "");
+    if(spill_directory.empty()){
+        spill_directory = args[2].find('/') == string::npos ? "." : args[2].substr(0, args[2].rfind('/'));
+    }
+    tik
+    Console::Show("Spilling hypergraph...");
+    SemiExternalHypergraph<W>* g = nullptr;
+    {
+        MemoryPhase phase("load");
+        g = new SemiExternalHypergraph<W>(args[1], args[2], spill_directory, arguments.has_option("compress-pins"));
+    }
+    Console::Show("Done. Weights are stored as " + string(WeightTypeName<W>()) + ".");
+    string output_file_name = get_output_file_name(args[1], query) + "_semiexternal_epsilon=" + Double2String(epsilon);
+    Output output(output_file_name.c_str());
+    vector<Hypergraph<W>*> ans;
+    if(query.algo == 1){
+        Console::Show("We perform semi-external [NaiveApprox(1)] on a dataset with " + Int2String(g->get_number_of_nodes()) + " nodes and " + std::to_string(g->get_number_of_edges()) + " edges with [k = " + Int2String(query.k) + "], [epsilon = " + Double2String(epsilon) + "].");
+        ans = SemiExternalAlgorithm::NaiveApprox(g, query.k, epsilon, output);
+    }else{
+        Console::Show("We perform semi-external [ApproxMinAndRemove(3)] on a dataset with " + Int2String(g->get_number_of_nodes()) + " nodes and " + std::to_string(g->get_number_of_edges()) + " edges with [k = " + Int2String(query.k) + "], [alpha = " + Double2String(query.alpha) + "], [epsilon = " + Double2String(epsilon) + "].");
+        ans = SemiExternalAlgorithm::ApproxMinAndRemove(g, query.k, query.alpha, query.way_to_remove_nodes, epsilon, output);
+    }
+    Console::Show("Spill file of " + std::to_string(g->get_bytes_of_spill()) + " bytes (compression ratio " + Double2String((double)g->get_bytes_of_raw_spill() / std::max(g->get_bytes_of_spill(), 1LL)) + "), streamed at " + Double2String(g->get_pins_per_second() / 1e6) + "M pins/s.");
+    delete g;
+    tok
+    Density<W> sum = 0.0;
+    for(const auto& h:ans){
+        sum += h->get_density();
+        delete h;
     }
     Console::Show("Total value is " + Double2String(sum) + ".");
     output.PrintLine("Total value is " + Double2String(sum) + ".");
-
     Console::Show(elapsed);
     output.PrintLine(elapsed);
+    if(arguments.has_option("memory-report") || MemoryTracker::is_limited()){
+        Console::Show(MemoryTracker::Report());
+    }
     return 0;
 }
+
+template<class W>
+int RunExpansion(const vector<string>& args, const Arguments& arguments){
+    string way = arguments.get_option("expand", "clique");
+    if(way != "clique" && way != "star"){
+        Console::Error("Unknown expansion <" + way + ">." + info);
+    }
+    int max_edge_size = String2Int(arguments.get_option("max-edge-size", "0"));
+    Console::Show("Reading hypergraph...");
+    Hypergraph<W>* g = new Hypergraph<W>(args[1].c_str(), args[2].c_str(), arguments.has_option("merge-edges"));
+    Console::Show("Done. Weights are stored as " + string(WeightTypeName<W>()) + ".");
+    tik
+    CsrGraph expansion = way == "clique" ? g->get_clique_expansion(max_edge_size, get_number_of_threads(arguments)) : g->get_star_expansion();
+    tok
+    Console::Show("Built the " + way + " expansion with " + Int2String(expansion.get_number_of_vertices()) + " vertices and " + std::to_string(expansion.get_number_of_arcs() / 2) + " edges. " + elapsed);
+    string output_file_name = "./result/" + RetrieveFileName(args[1]) + (way == "clique" ? "_[CliqueExpansion]_maxedgesize=" + Int2String(max_edge_size) : "_[StarExpansion]");
+    Output output(output_file_name.c_str());
+    int n = way == "clique" ? expansion.get_number_of_vertices() : g->get_number_of_nodes();
+    for(int u = 0; u < n; ++u){
+        for(const int* v = expansion.get_neighbors_begin(u); v != expansion.get_neighbors_end(u); ++v){
+            if(way == "star" || u < *v){
+                output.PrintLine(Int2String(expansion.get_vertex_id(u)) + " " + Int2String(expansion.get_vertex_id(*v)));
+            }
+        }
+    }
+    Console::Show("Written to <" + output_file_name + ">.");
+    delete g;
+    return 0;
+}
+
+/*
+ * The mode chosen by the options, run for weight type W.
+ */
+struct ModeRunner{
+const vector<string>& args;
+const Arguments& arguments;
+const TimeBudget& budget;
+template<class W> int Call() const{
+    if(arguments.has_option("serve")){
+        return Serve<W>(args, arguments);
+    }
+    if(arguments.has_option("dynamic")){
+        return RunDynamic<W>(args, arguments);
+    }
+    if(arguments.has_option("expand")){
+        return RunExpansion<W>(args, arguments);
+    }
+    if(arguments.has_option("semi-external")){
+        return RunSemiExternal<W>(args, arguments);
+    }
+    if(arguments.has_option("uniqueness")){
+        return RunUniqueness<W>(args, arguments);
+    }
+    return Run<W>(args, arguments, budget);
+}
+};
+
+int main(const int argc, const char* argv[]){
+    Arguments arguments(argc, argv, options_with_value);
+    ThreadPool::set_number_of_shared_threads(get_number_of_threads(arguments));
+    if(arguments.has_option("memory-limit")){
+        MemoryTracker::set_limit((long long)(String2Double(arguments.get_option("memory-limit", "0")) * 1048576));
+    }
+    if(arguments.has_option("seed")){
+        get_random_seed() = std::stoul(arguments.get_option("seed", "0"));
+        SeedRandomEngine(0);
+    }
+    if(arguments.has_option("lp-solver")){
+        LpSolver<double>::set_backend(arguments.get_option("lp-solver", ""));
+    }
+    if(arguments.has_option("batch")){
+        return RunBatch(arguments);
+    }
+    TimeBudget budget;
+    if(arguments.has_option("time-budget")){
+        budget = TimeBudget(String2Double(arguments.get_option("time-budget", "0")));
+    }
+    vector<string> args;
+    for(int i = 0; i < arguments.get_number_of_positional(); ++i){
+        args.push_back(arguments.get_positional(i));
+    }
+    if(args.size() < 3 || args.size() > 7){
+        Console::Error(info);
+    }
+    if(arguments.has_option("stats")){
+        DatasetProfile profile(args[1], args[2], get_number_of_threads(arguments));
+        std::cout << profile.ToJson() << std::endl;
+        return 0;
+    }
+    string weight_type = get_weight_type(arguments, args[1], args[2]);
+    /* Updates carry weights, so a detected unweighted input is read as int64. */
+    if(arguments.has_option("dynamic") && weight_type == "unweighted" && arguments.get_option("weight-type", "auto") == "auto"){
+        weight_type = "int64";
+    }
+    return DispatchWeightType(weight_type, ModeRunner{args, arguments, budget});
+}
@@ -0,0 +1,533 @@
+/*
+ *
+ * For paper 'Finding Subgraphs with Maximum Total Density and Limited Overlap in Weighted Hypergraphs'
+ *
+ * Copyright reserved.
+ *
+ */
+
+#include "stats.h"
+#include "data_structure.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+string JsonNumber(const double x){
+    char buff[32];
+    snprintf(buff, sizeof(buff), "%.10g", x);
+    return buff;
+}
+
+/**********Histogram**********/
+
+void Histogram::Add(const double x){
+    ++count;
+    sum += x;
+    minimum = std::min(minimum, x);
+    maximum = std::max(maximum, x);
+    if(x <= 0){
+        ++zeros;
+        return;
+    }
+    ++buckets[std::max(0, std::min(127, std::ilogb(x) + 64))];
+}
+
+void Histogram::Merge(const Histogram& other){
+    count += other.count;
+    zeros += other.zeros;
+    sum += other.sum;
+    minimum = std::min(minimum, other.minimum);
+    maximum = std::max(maximum, other.maximum);
+    for(int i = 0; i < (int)buckets.size(); ++i){
+        buckets[i] += other.buckets[i];
+    }
+}
+
+string Histogram::ToJson() const{
+    if(count == 0){
+        return "{\"count\": 0}";
+    }
+    string ans = "{\"count\": " + std::to_string(count) + ", \"min\": " + JsonNumber(minimum) + ", \"max\": " + JsonNumber(maximum) + ", \"mean\": " + JsonNumber(sum / count) + ", \"sum\": " + JsonNumber(sum) + ", \"zeros\": " + std::to_string(zeros) + ", \"buckets\": [";
+    bool is_first = true;
+    for(int i = 0; i < (int)buckets.size(); ++i){
+        if(buckets[i] == 0){
+            continue;
+        }
+        ans += string(is_first ? "" : ", ") + "{\"lower\": " + JsonNumber(std::ldexp(1.0, i - 64)) + ", \"count\": " + std::to_string(buckets[i]) + "}";
+        is_first = false;
+    }
+    return ans + "]}";
+}
+
+/**********MappedFile**********/
+
+/*
+ * Whole input file mapped read-only; parsing never reads past get_end().
+ */
+class MappedFile{
+
+private:
+char* data_;
+size_t size_;
+
+public:
+MappedFile(const string path): data_(nullptr), size_(0){
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat status;
+    if(fd < 0 || fstat(fd, &status) != 0){
+        Console::Error("Cannot open <" + path + ">.");
+    }
+    size_ = status.st_size;
+    if(size_ > 0){
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data == MAP_FAILED){
+            Console::Error("Cannot map <" + path + ">.");
+        }
+        data_ = (char*)data;
+        madvise(data_, size_, MADV_SEQUENTIAL);
+    }
+    close(fd);
+}
+~MappedFile(){
+    if(data_ != nullptr){
+        munmap(data_, size_);
+    }
+}
+const char* get_begin() const{
+    return data_;
+}
+const char* get_end() const{
+    return data_ + size_;
+}
+/*
+ * Splits the file into pieces that start at line beginnings.
+ */
+vector<const char*> Split(const int number_of_pieces) const{
+    vector<const char*> ans(number_of_pieces + 1, get_end());
+    ans[0] = get_begin();
+    for(int i = 1; i < number_of_pieces; ++i){
+        const char* p = std::max(ans[i - 1], get_begin() + size_ / number_of_pieces * i);
+        while(p < get_end() && p > get_begin() && p[-1] != '\n'){
+            ++p;
+        }
+        ans[i] = p;
+    }
+    return ans;
+}
+
+};
+
+/**********Parsing**********/
+
+const char* SkipBlanks(const char* p, const char* end){
+    while(p < end && (*p == ' ' || *p == '\t' || *p == '\r')){
+        ++p;
+    }
+    return p;
+}
+
+bool ParseInt(const char*& p, const char* end, int& x){
+    bool is_negative = false;
+    if(p < end && (*p == '-' || *p == '+')){
+        is_negative = *p == '-';
+        ++p;
+    }
+    if(p == end || *p < '0' || *p > '9'){
+        return false;
+    }
+    int64_t value = 0;
+    while(p < end && *p >= '0' && *p <= '9'){
+        value = value * 10 + (*p++ - '0');
+    }
+    x = is_negative ? -value : value;
+    return true;
+}
+
+bool ParseDouble(const char*& p, const char* end, double& x){
+    char buff[64];
+    int n = 0;
+    while(p < end && n < 63 && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n'){
+        buff[n++] = *p++;
+    }
+    buff[n] = '\0';
+    char* rest = nullptr;
+    x = strtod(buff, &rest);
+    return n > 0 && *rest == '\0';
+}
+
+/*
+ * Runs task(chunk, begin, end) on the shared pool for equal slices of [0, n).
+ */
+void ForEachChunk(const int64_t n, const int number_of_chunks, const std::function<void(int, int64_t, int64_t)>& task){
+    TaskGroup group;
+    for(int c = 0; c < number_of_chunks; ++c){
+        group.Run([&task, n, number_of_chunks, c](){
+            task(c, n * c / number_of_chunks, n * (c + 1) / number_of_chunks);
+        });
+    }
+    group.Wait();
+}
+
+/**********DatasetProfile**********/
+
+DatasetProfile::DatasetProfile(const string node_file, const string edge_file, const int number_of_threads): number_of_threads_(std::max(number_of_threads, 1)), number_of_isolated_nodes_(0), number_of_components_(0), size_of_largest_component_(0), max_core_(0), greedy_density_(0){
+    tik
+    ReadNodes(node_file);
+    ReadEdges(edge_file);
+    auto time_read = std::chrono::high_resolution_clock::now();
+    BuildIncidence();
+    CountComponents();
+    FindMaxCore();
+    FindGreedyDensity();
+    tok
+    seconds_of_reading_ = std::chrono::duration<double>(time_read - time_start).count();
+    seconds_of_profiling_ = std::chrono::duration<double>(time_end - time_read).count();
+}
+
+void DatasetProfile::ReadNodes(const string path){
+    MappedFile file(path);
+    int number_of_chunks = 4 * number_of_threads_;
+    vector<const char*> pieces = file.Split(number_of_chunks);
+    vector<vector<int> > ids(number_of_chunks);
+    vector<vector<double> > weights(number_of_chunks);
+    ForEachChunk(number_of_chunks, number_of_chunks, [&](int c, int64_t, int64_t){
+        for(const char* p = pieces[c]; p < pieces[c + 1]; ){
+            const char* end = std::find(p, pieces[c + 1], '\n');
+            int id;
+            double weight;
+            const char* q = SkipBlanks(p, end);
+            if(ParseInt(q, end, id) && ParseDouble(q = SkipBlanks(q, end), end, weight)){
+                ids[c].push_back(id);
+                weights[c].push_back(weight);
+            }
+            p = end + 1;
+        }
+    });
+    for(int c = 0; c < number_of_chunks; ++c){
+        node_ids_.insert(node_ids_.end(), ids[c].begin(), ids[c].end());
+        node_weights_.insert(node_weights_.end(), weights[c].begin(), weights[c].end());
+    }
+}
+
+/*
+ * Pins are deduplicated per edge, as a Hypergraph would, and mapped to
+ * node indices in file order of the nodes file.
+ */
+void DatasetProfile::ReadEdges(const string path){
+    HashMap<int, int> index;
+    index.reserve(node_ids_.size());
+    for(int v = 0; v < (int)node_ids_.size(); ++v){
+        index.insert(std::make_pair(node_ids_[v], v));
+    }
+    MappedFile file(path);
+    int number_of_chunks = 4 * number_of_threads_;
+    vector<const char*> pieces = file.Split(number_of_chunks);
+    vector<vector<int64_t> > sizes(number_of_chunks);
+    vector<vector<int> > pins(number_of_chunks);
+    vector<vector<double> > weights(number_of_chunks);
+    std::atomic<int64_t> number_of_undefined_pins(0);
+    ForEachChunk(number_of_chunks, number_of_chunks, [&](int c, int64_t, int64_t){
+        for(const char* p = pieces[c]; p < pieces[c + 1]; ){
+            const char* end = std::find(p, pieces[c + 1], '\n');
+            size_t first = pins[c].size();
+            const char* q = SkipBlanks(p, end);
+            int node_id;
+            while(ParseInt(q, end, node_id)){
+                auto x = index.find(node_id);
+                if(x == index.end()){
+                    ++number_of_undefined_pins;
+                }else{
+                    pins[c].push_back(x->second);
+                }
+                if(q == end || *q != ','){
+                    break;
+                }
+                ++q;
+            }
+            double weight;
+            if(pins[c].size() > first && ParseDouble(q = SkipBlanks(q, end), end, weight)){
+                std::sort(pins[c].begin() + first, pins[c].end());
+                pins[c].erase(std::unique(pins[c].begin() + first, pins[c].end()), pins[c].end());
+                sizes[c].push_back(pins[c].size() - first);
+                weights[c].push_back(weight);
+            }else{
+                pins[c].resize(first);
+            }
+            p = end + 1;
+        }
+    });
+    if(number_of_undefined_pins > 0){
+        Console::Error("Undefined Node.");
+    }
+
+    vector<int64_t> first_edge(number_of_chunks + 1, 0), first_pin(number_of_chunks + 1, 0);
+    for(int c = 0; c < number_of_chunks; ++c){
+        first_edge[c + 1] = first_edge[c] + sizes[c].size();
+        first_pin[c + 1] = first_pin[c] + pins[c].size();
+    }
+    pin_offsets_.assign(first_edge[number_of_chunks] + 1, 0);
+    pins_.resize(first_pin[number_of_chunks]);
+    edge_weights_.resize(first_edge[number_of_chunks]);
+    ForEachChunk(number_of_chunks, number_of_chunks, [&](int c, int64_t, int64_t){
+        int64_t offset = first_pin[c];
+        for(int64_t i = 0; i < (int64_t)sizes[c].size(); ++i){
+            pin_offsets_[first_edge[c] + i] = offset;
+            offset += sizes[c][i];
+        }
+        std::copy(pins[c].begin(), pins[c].end(), pins_.begin() + first_pin[c]);
+        std::copy(weights[c].begin(), weights[c].end(), edge_weights_.begin() + first_edge[c]);
+        vector<int>().swap(pins[c]);
+    });
+    pin_offsets_.back() = pins_.size();
+}
+
+/*
+ * Node-to-edge incidence in CSR form, together with the histograms that
+ * need one look at every edge or node.
+ */
+void DatasetProfile::BuildIncidence(){
+    int n = node_ids_.size();
+    int64_t m = edge_weights_.size();
+    int number_of_chunks = 4 * number_of_threads_;
+    vector<std::atomic<int64_t> > degree(n);
+    ForEachChunk(n, number_of_chunks, [&](int, int64_t begin, int64_t end){
+        for(int64_t v = begin; v < end; ++v){
+            degree[v].store(0, std::memory_order_relaxed);
+        }
+    });
+    vector<Histogram> cardinalities(number_of_chunks), weights_of_edges(number_of_chunks);
+    ForEachChunk(m, number_of_chunks, [&](int c, int64_t begin, int64_t end){
+        for(int64_t e = begin; e < end; ++e){
+            cardinalities[c].Add(pin_offsets_[e + 1] - pin_offsets_[e]);
+            weights_of_edges[c].Add(edge_weights_[e]);
+            for(int64_t i = pin_offsets_[e]; i < pin_offsets_[e + 1]; ++i){
+                degree[pins_[i]].fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    });
+    incidence_offsets_.assign(n + 1, 0);
+    for(int v = 0; v < n; ++v){
+        incidence_offsets_[v + 1] = incidence_offsets_[v] + degree[v].load(std::memory_order_relaxed);
+        degree[v].store(incidence_offsets_[v], std::memory_order_relaxed);
+    }
+    incidence_.resize(pins_.size());
+    ForEachChunk(m, number_of_chunks, [&](int, int64_t begin, int64_t end){
+        for(int64_t e = begin; e < end; ++e){
+            for(int64_t i = pin_offsets_[e]; i < pin_offsets_[e + 1]; ++i){
+                incidence_[degree[pins_[i]].fetch_add(1, std::memory_order_relaxed)] = e;
+            }
+        }
+    });
+    vector<Histogram> degrees(number_of_chunks), weights_of_nodes(number_of_chunks);
+    ForEachChunk(n, number_of_chunks, [&](int c, int64_t begin, int64_t end){
+        for(int64_t v = begin; v < end; ++v){
+            degrees[c].Add(incidence_offsets_[v + 1] - incidence_offsets_[v]);
+            weights_of_nodes[c].Add(node_weights_[v]);
+        }
+    });
+    for(int c = 0; c < number_of_chunks; ++c){
+        cardinalities_.Merge(cardinalities[c]);
+        weights_of_edges_.Merge(weights_of_edges[c]);
+        degrees_.Merge(degrees[c]);
+        weights_of_nodes_.Merge(weights_of_nodes[c]);
+    }
+    number_of_isolated_nodes_ = degrees_.zeros;
+}
+
+/*
+ * Concurrent union-find over the pins of every edge; a root is only ever
+ * linked below a smaller index, so parents decrease and never form cycles.
+ */
+void DatasetProfile::CountComponents(){
+    int n = node_ids_.size();
+    int64_t m = edge_weights_.size();
+    int number_of_chunks = 4 * number_of_threads_;
+    vector<std::atomic<int> > parent(n);
+    ForEachChunk(n, number_of_chunks, [&](int, int64_t begin, int64_t end){
+        for(int64_t v = begin; v < end; ++v){
+            parent[v].store(v);
+        }
+    });
+    auto find = [&parent](int u){
+        while(true){
+            int p = parent[u].load();
+            if(p == u){
+                return u;
+            }
+            int g = parent[p].load();
+            if(g != p){
+                parent[u].compare_exchange_weak(p, g);
+            }
+            u = g;
+        }
+    };
+    ForEachChunk(m, number_of_chunks, [&](int, int64_t begin, int64_t end){
+        for(int64_t e = begin; e < end; ++e){
+            for(int64_t i = pin_offsets_[e] + 1; i < pin_offsets_[e + 1]; ++i){
+                int a = pins_[pin_offsets_[e]], b = pins_[i];
+                while(true){
+                    a = find(a);
+                    b = find(b);
+                    if(a == b){
+                        break;
+                    }
+                    if(a < b){
+                        std::swap(a, b);
+                    }
+                    int expected = a;
+                    if(parent[a].compare_exchange_strong(expected, b)){
+                        break;
+                    }
+                }
+            }
+        }
+    });
+    vector<int64_t> size(n, 0);
+    for(int v = 0; v < n; ++v){
+        ++size[find(v)];
+    }
+    for(int v = 0; v < n; ++v){
+        if(size[v] > 0){
+            ++number_of_components_;
+            size_of_largest_component_ = std::max(size_of_largest_component_, size[v]);
+        }
+    }
+}
+
+/*
+ * Bucket peeling (Batagelj and Zaversnik) where the degree of a node is
+ * its number of edges whose pins are all still present.
+ */
+void DatasetProfile::FindMaxCore(){
+    int n = node_ids_.size();
+    if(n == 0){
+        return;
+    }
+    vector<int> degree(n), position(n), order(n);
+    int max_degree = 0;
+    for(int v = 0; v < n; ++v){
+        degree[v] = incidence_offsets_[v + 1] - incidence_offsets_[v];
+        max_degree = std::max(max_degree, degree[v]);
+    }
+    vector<int> bucket_begin(max_degree + 2, 0);
+    for(int v = 0; v < n; ++v){
+        ++bucket_begin[degree[v] + 1];
+    }
+    for(int d = 0; d <= max_degree; ++d){
+        bucket_begin[d + 1] += bucket_begin[d];
+    }
+    vector<int> next(bucket_begin.begin(), bucket_begin.end() - 1);
+    for(int v = 0; v < n; ++v){
+        position[v] = next[degree[v]]++;
+        order[position[v]] = v;
+    }
+    vector<bool> is_removed(n, false), is_dead(edge_weights_.size(), false);
+    for(int i = 0; i < n; ++i){
+        int v = order[i];
+        int d = degree[v];
+        max_core_ = std::max(max_core_, d);
+        is_removed[v] = true;
+        for(int64_t j = incidence_offsets_[v]; j < incidence_offsets_[v + 1]; ++j){
+            int e = incidence_[j];
+            if(is_dead[e]){
+                continue;
+            }
+            is_dead[e] = true;
+            for(int64_t k = pin_offsets_[e]; k < pin_offsets_[e + 1]; ++k){
+                int u = pins_[k];
+                if(is_removed[u] || degree[u] <= d){
+                    continue;
+                }
+                int w = order[bucket_begin[degree[u]]];
+                if(u != w){
+                    std::swap(order[position[u]], order[bucket_begin[degree[u]]]);
+                    std::swap(position[u], position[w]);
+                }
+                ++bucket_begin[degree[u]];
+                --degree[u];
+            }
+        }
+    }
+}
+
+/*
+ * The greedy peeling of GreedyAlgorithm on the flat arrays: repeatedly
+ * remove the node of least weighted degree and keep the densest suffix.
+ */
+void DatasetProfile::FindGreedyDensity(){
+    int n = node_ids_.size();
+    vector<double> weight_of_edges(n, 0);
+    double total_of_nodes = 0, total_of_edges = 0;
+    for(int v = 0; v < n; ++v){
+        total_of_nodes += node_weights_[v];
+        for(int64_t j = incidence_offsets_[v]; j < incidence_offsets_[v + 1]; ++j){
+            weight_of_edges[v] += edge_weights_[incidence_[j]];
+        }
+    }
+    for(const auto& w:edge_weights_){
+        total_of_edges += w;
+    }
+    auto get_degree = [&](int v){
+        return cmp(node_weights_[v], 0) == 0 ? 0 : weight_of_edges[v] / node_weights_[v];
+    };
+    std::priority_queue<std::pair<double, int>, vector<std::pair<double, int> >, std::greater<std::pair<double, int> > > heap;
+    for(int v = 0; v < n; ++v){
+        heap.push(std::make_pair(get_degree(v), v));
+    }
+    vector<bool> is_removed(n, false), is_dead(edge_weights_.size(), false);
+    while(!heap.empty()){
+        auto x = heap.top();
+        heap.pop();
+        int v = x.second;
+        if(is_removed[v] || x.first != get_degree(v)){
+            continue;
+        }
+        if(cmp(total_of_nodes, 0) > 0){
+            greedy_density_ = std::max(greedy_density_, total_of_edges / total_of_nodes);
+        }
+        is_removed[v] = true;
+        total_of_nodes -= node_weights_[v];
+        for(int64_t j = incidence_offsets_[v]; j < incidence_offsets_[v + 1]; ++j){
+            int e = incidence_[j];
+            if(is_dead[e]){
+                continue;
+            }
+            is_dead[e] = true;
+            total_of_edges -= edge_weights_[e];
+            for(int64_t k = pin_offsets_[e]; k < pin_offsets_[e + 1]; ++k){
+                int u = pins_[k];
+                if(!is_removed[u]){
+                    weight_of_edges[u] -= edge_weights_[e];
+                    heap.push(std::make_pair(get_degree(u), u));
+                }
+            }
+        }
+    }
+}
+
+string DatasetProfile::ToJson() const{
+    string ans = "{";
+    ans += "\"nodes\": " + std::to_string(node_ids_.size());
+    ans += ", \"edges\": " + std::to_string(edge_weights_.size());
+    ans += ", \"pins\": " + std::to_string(pins_.size());
+    ans += ", \"node_degree\": " + degrees_.ToJson();
+    ans += ", \"edge_cardinality\": " + cardinalities_.ToJson();
+    ans += ", \"node_weight\": " + weights_of_nodes_.ToJson();
+    ans += ", \"edge_weight\": " + weights_of_edges_.ToJson();
+    ans += ", \"isolated_nodes\": " + std::to_string(number_of_isolated_nodes_);
+    ans += ", \"components\": " + std::to_string(number_of_components_);
+    ans += ", \"largest_component\": " + std::to_string(size_of_largest_component_);
+    ans += ", \"max_core\": " + std::to_string(max_core_);
+    ans += ", \"greedy_density\": " + JsonNumber(greedy_density_);
+    ans += ", \"threads\": " + std::to_string(number_of_threads_);
+    ans += ", \"seconds\": {\"read\": " + JsonNumber(seconds_of_reading_) + ", \"profile\": " + JsonNumber(seconds_of_profiling_) + "}";
+    return ans + "}";
+}
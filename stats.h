@@ -0,0 +1,74 @@
+/*
+ *
+ * For paper 'Finding Subgraphs with Maximum Total Density and Limited Overlap in Weighted Hypergraphs'
+ *
+ * Copyright reserved.
+ *
+ */
+
+#ifndef __STATS__
+#define __STATS__
+
+#include "macro.h"
+#include "utility.h"
+
+/**********Histogram**********/
+
+/*
+ * Count, sum, extremes and power-of-two buckets of nonnegative values;
+ * bucket i holds [2^(i-64), 2^(i-63)) and zeros are counted apart.
+ */
+struct Histogram{
+int64_t count = 0;
+int64_t zeros = 0;
+double sum = 0;
+double minimum = kInf;
+double maximum = -kInf;
+vector<int64_t> buckets = vector<int64_t>(128, 0);
+void Add(const double);
+void Merge(const Histogram&);
+string ToJson() const;
+};
+
+/**********DatasetProfile**********/
+
+/*
+ * Shape of a dataset, read from the two input files straight into flat
+ * arrays rather than a Hypergraph, so that the profile of a billion-pin
+ * input costs a few parallel passes. Weights are read as double whatever
+ * weight type a run would pick.
+ */
+class DatasetProfile{
+
+private:
+int number_of_threads_;
+vector<int> node_ids_;
+vector<double> node_weights_;
+vector<int64_t> pin_offsets_;
+vector<int> pins_;
+vector<double> edge_weights_;
+vector<int64_t> incidence_offsets_;
+vector<int> incidence_;
+Histogram degrees_, cardinalities_, weights_of_nodes_, weights_of_edges_;
+int64_t number_of_isolated_nodes_;
+int64_t number_of_components_;
+int64_t size_of_largest_component_;
+int max_core_;
+double greedy_density_;
+double seconds_of_reading_, seconds_of_profiling_;
+void ReadNodes(const string);
+void ReadEdges(const string);
+void BuildIncidence();
+void CountComponents();
+void FindMaxCore();
+void FindGreedyDensity();
+
+public:
+DatasetProfile(const string, const string, const int);
+string ToJson() const;
+
+};
+
+// #include "stats.cc"
+
+#endif // __STATS__
@@ -10,21 +10,25 @@
 
 #include <time.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 #include <iostream>
 #include <algorithm>
 
 
 Output Console::log_file_(LOGFILE);
+std::mutex Console::mutex_;
+std::recursive_mutex Console::error_mutex_;
 
 /**********Console**********/
 
 string Console::Time(){
     time_t raw_time;
-    struct tm* time_info;
+    struct tm time_info;
+    char buff[32];
     time(&raw_time);
-    time_info = localtime(&raw_time);
-    return asctime(time_info);
+    localtime_r(&raw_time, &time_info);
+    return asctime_r(&time_info, buff);
 }
 
 void Console::Abort(){
@@ -33,7 +37,12 @@ void Console::Abort(){
     exit(1);
 }
 
+/*
+ * The error mutex is never released, so errors raised concurrently by
+ * other threads wait for the first one to end the run.
+ */
 void Console::Error(const string err){
+    error_mutex_.lock();
     Show("[Error]");
     Show(err);
     Show("");
@@ -42,10 +51,12 @@ void Console::Error(const string err){
 }
 
 void Console::Log(const string context){
+    std::lock_guard<std::mutex> lock(mutex_);
     log_file_.PrintLine(context);
 }
 
 void Console::Show(const string context){
+    std::lock_guard<std::mutex> lock(mutex_);
     std::cerr << context << std::endl;
 }
 
@@ -109,10 +120,26 @@ Output::Output(const Output& other): File(other.path_, std::ios::out){}
 
 Output::Output(const char* path): File(path, std::ios::out){}
 
-Output::Output(const int n, const char* path): File(path, std::ios::out | std::ios::app){}
+Output::Output(const int, const char* path): File(path, std::ios::out | std::ios::app){}
+
+/*
+ * Like PrintLine, without the line break and the flush.
+ */
+void Output::Print(const string context){
+    try{
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(!file_.is_open()){
+            throw 0;
+        }
+        file_ << context;
+    }catch(...){
+        Console::Error("Output error.");
+    }
+}
 
 void Output::PrintLine(const string context){
     try{
+        std::lock_guard<std::mutex> lock(mutex_);
         if(!file_.is_open()){
             throw 0;
         }
@@ -123,6 +150,522 @@ void Output::PrintLine(const string context){
     }
 }
 
+long long Output::get_size(){
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_.flush();
+    return file_.tellp();
+}
+
+/**********MemoryTracker**********/
+
+struct MemoryTracker::State{
+std::mutex mutex;
+std::map<string, long long> current, peak;
+std::map<string, long long> peak_of_phases;
+long long total = 0;
+long long limit = 0;
+};
+
+thread_local vector<string> phases_of_thread;
+
+/*
+ * Never destroyed, so arenas released during exit still find it.
+ */
+MemoryTracker::State& MemoryTracker::get_state(){
+    static State* state = new State();
+    return *state;
+}
+
+void MemoryTracker::Fail(const string reason){
+    string phase = phases_of_thread.empty() ? "main" : phases_of_thread.back();
+    Console::Error("Memory limit of " + std::to_string(get_state().limit >> 20) + " MB exceeded in phase <" + phase + ">: " + reason + ".\n" + Report());
+}
+
+void MemoryTracker::Charge(const string category, const long long bytes){
+    State& state = get_state();
+    bool is_exceeded = false;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.total += bytes;
+        long long& current = state.current[category];
+        current += bytes;
+        state.peak[category] = std::max(state.peak[category], current);
+        for(const auto& x:phases_of_thread){
+            long long& peak = state.peak_of_phases[x];
+            peak = std::max(peak, state.total);
+        }
+        is_exceeded = state.limit > 0 && state.total > state.limit;
+    }
+    if(is_exceeded){
+        Fail("tracked structures hold " + std::to_string(get_total() >> 20) + " MB");
+    }
+}
+
+void MemoryTracker::Release(const string category, const long long bytes){
+    State& state = get_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.total -= bytes;
+    state.current[category] -= bytes;
+}
+
+void MemoryTracker::BeginPhase(const string phase){
+    phases_of_thread.push_back(phase);
+    State& state = get_state();
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        long long& peak = state.peak_of_phases[phase];
+        peak = std::max(peak, state.total);
+    }
+    Check();
+}
+
+void MemoryTracker::EndPhase(){
+    Check();
+    phases_of_thread.pop_back();
+}
+
+/*
+ * The resident set also covers what no structure reports, e.g. the solver
+ * library; it is read only at phase boundaries.
+ */
+void MemoryTracker::Check(){
+    if(!is_limited()){
+        return;
+    }
+    long long resident = get_resident();
+    if(resident > get_state().limit){
+        Fail("the process holds " + std::to_string(resident >> 20) + " MB");
+    }
+}
+
+void MemoryTracker::set_limit(const long long bytes){
+    State& state = get_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.limit = bytes;
+}
+
+bool MemoryTracker::is_limited(){
+    State& state = get_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.limit > 0;
+}
+
+long long MemoryTracker::get_total(){
+    State& state = get_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.total;
+}
+
+long long MemoryTracker::get_resident(){
+    std::ifstream statm("/proc/self/statm");
+    long long pages = 0, resident_pages = 0;
+    if(!(statm >> pages >> resident_pages)){
+        return 0;
+    }
+    return resident_pages * sysconf(_SC_PAGESIZE);
+}
+
+string MemoryTracker::Report(){
+    State& state = get_state();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    auto megabytes = [](const long long bytes){
+        return Double2String(bytes / 1048576.0) + " MB";
+    };
+    string ans = "Memory (current / peak):\n";
+    for(const auto& x:state.current){
+        ans += "    " + x.first + ": " + megabytes(x.second) + " / " + megabytes(state.peak[x.first]) + "\n";
+    }
+    ans += "Peak of tracked memory per phase:\n";
+    for(const auto& x:state.peak_of_phases){
+        ans += "    " + x.first + ": " + megabytes(x.second) + "\n";
+    }
+    return ans + "Resident: " + megabytes(get_resident());
+}
+
+MemoryPhase::MemoryPhase(const string phase){
+    MemoryTracker::BeginPhase(phase);
+}
+
+MemoryPhase::~MemoryPhase(){
+    MemoryTracker::EndPhase();
+}
+
+MemoryCharge::MemoryCharge(const string category, const long long bytes): category_(category), bytes_(bytes){
+    MemoryTracker::Charge(category_, bytes_);
+}
+
+MemoryCharge::~MemoryCharge(){
+    MemoryTracker::Release(category_, bytes_);
+}
+
+/**********Arguments**********/
+
+/*
+ * Only the options in options_with_value take the next token as their
+ * value; any other option is given one as --opt=value, so a flag never
+ * swallows a positional argument.
+ */
+Arguments::Arguments(const int argc, const char* argv[], const vector<string>& options_with_value){
+    for(int i = 0; i < argc; ++i){
+        string arg = argv[i];
+        if(arg.length() <= 2 || arg.compare(0, 2, "--") != 0){
+            positional_.push_back(arg);
+            continue;
+        }
+        auto pos = arg.find('=');
+        if(pos != string::npos){
+            options_[arg.substr(2, pos - 2)] = arg.substr(pos + 1);
+            continue;
+        }
+        string key = arg.substr(2);
+        if(std::find(options_with_value.begin(), options_with_value.end(), key) == options_with_value.end()){
+            options_[key] = "";
+        }else if(i + 1 < argc && string(argv[i + 1]).compare(0, 2, "--") != 0){
+            options_[key] = argv[++i];
+        }else{
+            Console::Error("Option --" + key + " needs a value.");
+        }
+    }
+}
+
+int Arguments::get_number_of_positional() const{
+    return positional_.size();
+}
+
+string Arguments::get_positional(const int index) const{
+    return positional_[index];
+}
+
+bool Arguments::has_option(const string key) const{
+    return options_.find(key) != options_.end();
+}
+
+string Arguments::get_option(const string key, const string default_value) const{
+    auto p = options_.find(key);
+    if(p == options_.end()){
+        return default_value;
+    }
+    return p->second;
+}
+
+/**********TimeBudget**********/
+
+TimeBudget::TimeBudget(): is_limited_(false){}
+
+TimeBudget::TimeBudget(const double seconds): is_limited_(true){
+    deadline_ = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+bool TimeBudget::is_limited() const{
+    return is_limited_;
+}
+
+bool TimeBudget::is_expired() const{
+    return is_limited_ && std::chrono::steady_clock::now() >= deadline_;
+}
+
+double TimeBudget::get_remaining_seconds() const{
+    if(!is_limited_){
+        return 1e100;
+    }
+    double remaining = std::chrono::duration<double>(deadline_ - std::chrono::steady_clock::now()).count();
+    return remaining > 0 ? remaining : 0;
+}
+
+/**********ThreadPool**********/
+
+/* The pool a worker belongs to and its index there; null and -1 elsewhere. */
+thread_local const ThreadPool* pool_of_thread = nullptr;
+thread_local int index_of_thread = -1;
+
+static int number_of_shared_threads = 0;
+
+ThreadPool::ThreadPool(const int number_of_threads): number_of_queued_(0), number_of_unfinished_(0), next_deque_(0), is_stopped_(false){
+    for(int i = 0; i < std::max(number_of_threads, 1); ++i){
+        deques_.push_back(std::unique_ptr<Deque>(new Deque()));
+    }
+    for(int i = 0; i < (int)deques_.size(); ++i){
+        workers_.push_back(std::thread(&ThreadPool::Work, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_stopped_ = true;
+    }
+    has_task_.notify_all();
+    for(auto& x:workers_){
+        x.join();
+    }
+}
+
+/*
+ * Takes effect if called before the first get_shared(); 0 means the
+ * number of hardware threads.
+ */
+void ThreadPool::set_number_of_shared_threads(const int number_of_threads){
+    number_of_shared_threads = number_of_threads;
+}
+
+/*
+ * Never destroyed, so tasks still running at exit find it.
+ */
+ThreadPool& ThreadPool::get_shared(){
+    static ThreadPool* pool = new ThreadPool(number_of_shared_threads > 0 ? number_of_shared_threads : std::thread::hardware_concurrency());
+    return *pool;
+}
+
+int ThreadPool::get_index_of_thread() const{
+    return pool_of_thread == this ? index_of_thread : -1;
+}
+
+/*
+ * The newest task of the own deque, else the oldest task of the first
+ * non-empty deque after it.
+ */
+bool ThreadPool::Take(const int index, std::function<void()>& task){
+    int n = deques_.size();
+    bool is_taken = false;
+    if(index >= 0){
+        Deque& deque = *deques_[index];
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        if(!deque.tasks.empty()){
+            task = std::move(deque.tasks.back());
+            deque.tasks.pop_back();
+            is_taken = true;
+        }
+    }
+    for(int i = 1; i <= n && !is_taken; ++i){
+        Deque& deque = *deques_[(std::max(index, 0) + i) % n];
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        if(!deque.tasks.empty()){
+            task = std::move(deque.tasks.front());
+            deque.tasks.pop_front();
+            is_taken = true;
+        }
+    }
+    if(is_taken){
+        std::lock_guard<std::mutex> lock(mutex_);
+        --number_of_queued_;
+    }
+    return is_taken;
+}
+
+void ThreadPool::Run(const std::function<void()>& task){
+    task();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(--number_of_unfinished_ == 0){
+        is_idle_.notify_all();
+    }
+}
+
+void ThreadPool::Work(const int index){
+    pool_of_thread = this;
+    index_of_thread = index;
+    while(true){
+        std::function<void()> task;
+        if(Take(index, task)){
+            Run(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        if(is_stopped_ && number_of_queued_ == 0){
+            return;
+        }
+        has_task_.wait(lock, [this](){ return is_stopped_ || number_of_queued_ > 0; });
+    }
+}
+
+int ThreadPool::get_number_of_threads() const{
+    return workers_.size();
+}
+
+/*
+ * A worker pushes onto its own deque; other threads take turns over the
+ * deques. The counters go first, so Wait() never sees a queued task as
+ * finished.
+ */
+void ThreadPool::Submit(const std::function<void()> task){
+    int index = get_index_of_thread();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++number_of_queued_;
+        ++number_of_unfinished_;
+        if(index < 0){
+            index = next_deque_++ % deques_.size();
+        }
+    }
+    {
+        Deque& deque = *deques_[index];
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        deque.tasks.push_back(task);
+    }
+    has_task_.notify_one();
+}
+
+/*
+ * Runs one queued task on the calling thread, if there is any.
+ */
+bool ThreadPool::RunPendingTask(){
+    std::function<void()> task;
+    if(!Take(get_index_of_thread(), task)){
+        return false;
+    }
+    Run(task);
+    return true;
+}
+
+void ThreadPool::Wait(){
+    std::unique_lock<std::mutex> lock(mutex_);
+    is_idle_.wait(lock, [this](){ return number_of_unfinished_ == 0; });
+}
+
+/**********TaskGroup**********/
+
+TaskGroup::TaskGroup(ThreadPool& pool): pool_(pool), number_of_running_(0){}
+
+TaskGroup::~TaskGroup(){
+    Join();
+}
+
+void TaskGroup::Run(const std::function<void()> task){
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++number_of_running_;
+    }
+    pool_.Submit([this, task](){
+        std::exception_ptr exception;
+        try{
+            task();
+        }catch(...){
+            exception = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(exception && !exception_){
+            exception_ = exception;
+        }
+        if(--number_of_running_ == 0){
+            is_done_.notify_all();
+        }
+    });
+}
+
+/*
+ * Sleeps only while the pool has nothing queued, i.e. while the tasks of
+ * the group are running elsewhere, and looks for work again every
+ * millisecond.
+ */
+void TaskGroup::Join(){
+    while(true){
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(number_of_running_ == 0){
+                return;
+            }
+        }
+        if(!pool_.RunPendingTask()){
+            std::unique_lock<std::mutex> lock(mutex_);
+            is_done_.wait_for(lock, std::chrono::milliseconds(1), [this](){ return number_of_running_ == 0; });
+        }
+    }
+}
+
+void TaskGroup::Wait(){
+    Join();
+    std::exception_ptr exception;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::swap(exception, exception_);
+    }
+    if(exception){
+        std::rethrow_exception(exception);
+    }
+}
+
+void ParallelFor(const int64_t begin, const int64_t end, const std::function<void(int64_t, int64_t)>& body, const int64_t grain, ThreadPool& pool){
+    int64_t n = end - begin;
+    if(n <= 0){
+        return;
+    }
+    int64_t number_of_slices = std::min((n + std::max(grain, (int64_t)1) - 1) / std::max(grain, (int64_t)1), (int64_t)4 * pool.get_number_of_threads());
+    if(number_of_slices <= 1){
+        body(begin, end);
+        return;
+    }
+    TaskGroup group(pool);
+    for(int64_t i = 1; i < number_of_slices; ++i){
+        group.Run([&body, begin, n, number_of_slices, i](){
+            body(begin + n * i / number_of_slices, begin + n * (i + 1) / number_of_slices);
+        });
+    }
+    body(begin, begin + n / number_of_slices);
+    group.Wait();
+}
+
+/**********AsyncOutput**********/
+
+AsyncOutput::AsyncOutput(Output& output, const int capacity): output_(output), capacity_(std::max(capacity, 1)), is_writing_(false), is_stopped_(false){
+    writer_ = std::thread(&AsyncOutput::Work, this);
+}
+
+AsyncOutput::~AsyncOutput(){
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        is_stopped_ = true;
+    }
+    has_job_.notify_all();
+    writer_.join();
+}
+
+void AsyncOutput::Work(){
+    while(true){
+        std::function<void(Output&)> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            has_job_.wait(lock, [this](){ return is_stopped_ || !jobs_.empty(); });
+            if(jobs_.empty()){
+                return;
+            }
+            job = jobs_.front();
+            jobs_.pop();
+            is_writing_ = true;
+        }
+        has_room_.notify_one();
+        job(output_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            is_writing_ = false;
+            if(jobs_.empty()){
+                is_idle_.notify_all();
+            }
+        }
+    }
+}
+
+void AsyncOutput::Submit(const std::function<void(Output&)> job){
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        has_room_.wait(lock, [this](){ return (int)jobs_.size() < capacity_; });
+        jobs_.push(job);
+    }
+    has_job_.notify_one();
+}
+
+void AsyncOutput::Wait(){
+    std::unique_lock<std::mutex> lock(mutex_);
+    is_idle_.wait(lock, [this](){ return !is_writing_ && jobs_.empty(); });
+}
+
+/*
+ * --threads=<n>, defaulting to the number of hardware threads.
+ */
+int get_number_of_threads(const Arguments& arguments){
+    int n = std::thread::hardware_concurrency();
+    n = String2Int(arguments.get_option("threads", Int2String(n > 0 ? n : 1)));
+    return n > 0 ? n : 1;
+}
+
 /**********...**********/
 
 string Int2String(const int x){
@@ -141,15 +684,25 @@ double String2Double(const string str){
     return atof(str.c_str());
 }
 
+template<class T>
+bool String2Value(const string str, T& value){
+    std::stringstream ss(str);
+    return ss >> value && ss.peek() == EOF;
+}
+
+template bool String2Value(const string, int64_t&);
+template bool String2Value(const string, double&);
+template bool String2Value(const string, long double&);
+
 string RetrieveFileName(const string str){
     int pos = 0;
-    for(int i = 0; i < str.length(); ++i){
+    for(int i = 0; i < (int)str.length(); ++i){
         if(str[i] == '/'){
             pos = i + 1;
         }
     }
     string ans = "";
-    for(; pos < str.length(); ++pos){
+    for(; pos < (int)str.length(); ++pos){
         if(str[pos] == '.'){
             ans += '_';
         }else{
@@ -13,9 +13,19 @@
 
 #include <string>
 #include <vector>
+#include <map>
 #include <sstream>
 #include <fstream>
 #include <chrono>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <queue>
+#include <deque>
+#include <memory>
+#include <exception>
+#include <cstdint>
 
 #ifndef LOGFILE
 #define LOGFILE "dslo.log"
@@ -54,21 +64,36 @@ bool NextLine(std::stringstream&);
 
 /**********Output**********/
 
+/*
+ * Print and PrintLine may be called from concurrent tasks; every call is
+ * written whole.
+ */
 class Output: public File{
+private:
+std::mutex mutex_;
+
 public:
 Output(const Output&);
 Output(const char*);
 Output(const int, const char*);
+void Print(const string);
 void PrintLine(const string);
+long long get_size();
 
 };
 
 /**********Console**********/
 
+/*
+ * Safe to call from any thread: messages are written whole, and only the
+ * first error reports and ends the run.
+ */
 class Console{
 
 private:
 static Output log_file_;
+static std::mutex mutex_;
+static std::recursive_mutex error_mutex_;
 static string Time();
 static void Abort();
 
@@ -79,6 +104,206 @@ static void Show(const string);
 
 };
 
+/**********MemoryTracker**********/
+
+/*
+ * Bytes held per structure ("graph", "copy", "scratch", "heap", "solver")
+ * and the peak of their sum within every phase. Structures report what
+ * they reserve, so the numbers are close estimates; the resident set size
+ * is read from /proc. Once a limit is set, exceeding it in either ends the
+ * run with a report instead of waiting for the OOM killer.
+ */
+class MemoryTracker{
+
+private:
+struct State;
+static State& get_state();
+static void Fail(const string);
+
+public:
+static void Charge(const string, const long long);
+static void Release(const string, const long long);
+static void BeginPhase(const string);
+static void EndPhase();
+static void Check();
+static void set_limit(const long long);
+static bool is_limited();
+static long long get_total();
+static long long get_resident();
+static string Report();
+
+};
+
+/*
+ * Scope of a named phase; phases nest per thread, and an allocation
+ * counts toward the peak of every enclosing phase.
+ */
+class MemoryPhase{
+
+public:
+MemoryPhase(const string);
+MemoryPhase(const MemoryPhase&) = delete;
+~MemoryPhase();
+
+};
+
+/*
+ * Bytes charged to a structure for the lifetime of the scope.
+ */
+class MemoryCharge{
+
+private:
+string category_;
+long long bytes_;
+
+public:
+MemoryCharge(const string, const long long);
+MemoryCharge(const MemoryCharge&) = delete;
+~MemoryCharge();
+
+};
+
+/**********Arguments**********/
+
+class Arguments{
+
+private:
+vector<string> positional_;
+std::map<string, string> options_;
+
+public:
+Arguments(const int, const char* [], const vector<string>&);
+int get_number_of_positional() const;
+string get_positional(const int) const;
+bool has_option(const string) const;
+string get_option(const string, const string) const;
+
+};
+
+/**********TimeBudget**********/
+
+class TimeBudget{
+
+private:
+bool is_limited_;
+std::chrono::steady_clock::time_point deadline_;
+
+public:
+TimeBudget();
+TimeBudget(const double);
+bool is_limited() const;
+bool is_expired() const;
+double get_remaining_seconds() const;
+
+};
+
+/**********ThreadPool**********/
+
+/*
+ * A fixed set of workers, each with its own deque of tasks. A worker runs
+ * the newest task of its deque and, when that is empty, steals the oldest
+ * task of another; tasks submitted from outside are spread over the deques.
+ * Wait() blocks until every submitted task has finished and is meant for
+ * the thread that owns the pool; tasks wait for their subtasks through a
+ * TaskGroup. The shared pool is sized by --threads.
+ */
+class ThreadPool{
+
+private:
+struct Deque{
+std::deque<std::function<void()> > tasks;
+std::mutex mutex;
+};
+vector<std::unique_ptr<Deque> > deques_;
+vector<std::thread> workers_;
+std::mutex mutex_;
+std::condition_variable has_task_, is_idle_;
+int number_of_queued_;
+int number_of_unfinished_;
+unsigned next_deque_;
+bool is_stopped_;
+int get_index_of_thread() const;
+bool Take(const int, std::function<void()>&);
+void Run(const std::function<void()>&);
+void Work(const int);
+
+public:
+ThreadPool(const int);
+~ThreadPool();
+static void set_number_of_shared_threads(const int);
+static ThreadPool& get_shared();
+int get_number_of_threads() const;
+void Submit(const std::function<void()>);
+bool RunPendingTask();
+void Wait();
+
+};
+
+/**********TaskGroup**********/
+
+/*
+ * Tasks run on a pool and waited for together. Wait() runs pending tasks of
+ * the pool while those of the group are unfinished, so tasks may wait for
+ * their own groups without starving the workers, and rethrows the first
+ * exception a task of the group threw.
+ */
+class TaskGroup{
+
+private:
+ThreadPool& pool_;
+std::mutex mutex_;
+std::condition_variable is_done_;
+int number_of_running_;
+std::exception_ptr exception_;
+void Join();
+
+public:
+TaskGroup(ThreadPool& = ThreadPool::get_shared());
+~TaskGroup();
+void Run(const std::function<void()>);
+void Wait();
+
+};
+
+/*
+ * Runs body(begin, end) over slices of [begin, end) of at least grain
+ * indices each, on the pool and the calling thread.
+ */
+void ParallelFor(const int64_t, const int64_t, const std::function<void(int64_t, int64_t)>&, const int64_t grain = 1, ThreadPool& = ThreadPool::get_shared());
+
+/**********AsyncOutput**********/
+
+/*
+ * Writes to an Output from a writer thread, so that a result is formatted
+ * and written while the next one is computed. Jobs run one at a time in
+ * the order they were submitted, which leaves the file as if they had run
+ * in place; Submit blocks while capacity jobs are pending. Whatever a job
+ * reads must stay unchanged until Wait() returns, which the destructor
+ * also calls.
+ */
+class AsyncOutput{
+
+private:
+Output& output_;
+std::queue<std::function<void(Output&)> > jobs_;
+std::mutex mutex_;
+std::condition_variable has_job_, has_room_, is_idle_;
+int capacity_;
+bool is_writing_;
+bool is_stopped_;
+std::thread writer_;
+void Work();
+
+public:
+AsyncOutput(Output&, const int capacity = 2);
+~AsyncOutput();
+void Submit(const std::function<void(Output&)>);
+void Wait();
+
+};
+
+int get_number_of_threads(const Arguments&);
+
 /**********...**********/
 
 string Int2String(const int);
@@ -89,6 +314,10 @@ string Double2String(const double);
 
 double String2Double(const string);
 
+/* Reads the whole string as a T with operator>>; false if anything is left. */
+template<class T>
+bool String2Value(const string, T&);
+
 string RetrieveFileName(const string);
 
 // #include "utility.cc"